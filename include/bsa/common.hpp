@@ -2,20 +2,70 @@
 
 #include "bsa/stl.hpp"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cerrno>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
+#include <fstream>
 #include <functional>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <ostream>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include <boost/endian/conversion.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(IORING_FEAT_RW_CUR_POS)
+#define BSA_HAS_IO_URING
+#endif
+#endif
+#endif
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BSA_HAS_SSE2
+#endif
+
+// carry-less multiply is picked at runtime, so it only needs the compiler to accept it
+#if defined(BSA_HAS_SSE2) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#if defined(__GNUC__) || defined(__clang__)
+#include <wmmintrin.h>
+#define BSA_HAS_PCLMUL
+#define BSA_TARGET_PCLMUL __attribute__((target("pclmul")))
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#include <wmmintrin.h>
+#define BSA_HAS_PCLMUL
+#define BSA_TARGET_PCLMUL
+#endif
+#endif
+
 // TODO
 #pragma warning(disable : 4820)	 // 'bytes' bytes padding added after construct 'member_name'
 
@@ -247,6 +297,29 @@ namespace bsa
 		empty_file& operator=(empty_file&&) = default;
 	};
 
+	class decompress_error : public input_error
+	{
+	private:
+		using super = input_error;
+
+	public:
+		inline decompress_error() noexcept :
+			decompress_error("failed to decompress file data")
+		{}
+
+		inline decompress_error(const decompress_error&) = default;
+		inline decompress_error(decompress_error&&) = default;
+
+		inline decompress_error(const char* a_what) noexcept :
+			super(a_what)
+		{}
+
+		~decompress_error() = default;
+
+		decompress_error& operator=(const decompress_error&) = default;
+		decompress_error& operator=(decompress_error&&) = default;
+	};
+
 	class output_error : public io_error
 	{
 	private:
@@ -284,6 +357,124 @@ namespace bsa
 				stl::is_pointer_v<T>>>
 	using owner = T;  // owning raw pointer
 
+	// how an archive gets at the bytes of the file it's read from. whichever is picked, the
+	// archive sees one contiguous view of the file for as long as it's alive
+	enum class io_backend
+	{
+		mmap,	// map the file, hinting the expected access pattern of each operation
+		pread,	// read the whole file into memory up front, so no access ever faults
+		direct	// like pread, but bypassing the page cache where the filesystem allows it
+	};
+
+	// where archives write their output to. writes are buffered before they get here, so
+	// implementations see a few large chunks rather than one call per record field
+	class osink
+	{
+	public:
+		osink() noexcept = default;
+		osink(const osink&) = default;
+		osink(osink&&) = default;
+
+		virtual ~osink() = default;
+
+		osink& operator=(const osink&) = default;
+		osink& operator=(osink&&) = default;
+
+		// writes all of a_data, or throws
+		virtual void write(stl::span<const stl::byte> a_data) = 0;
+	};
+
+	class ostream_sink final :
+		public osink
+	{
+	public:
+		inline ostream_sink(std::ostream& a_stream) :
+			_stream(a_stream)
+		{
+			if (!_stream) {
+				throw output_error();
+			}
+		}
+
+		inline void write(stl::span<const stl::byte> a_data) override
+		{
+			_stream.write(
+				reinterpret_cast<const char*>(a_data.data()),
+				static_cast<std::streamsize>(a_data.size()));
+			if (!_stream) {
+				throw output_error();
+			}
+		}
+
+	private:
+		std::ostream& _stream;
+	};
+
+	// collects the output in a growable buffer
+	class memory_sink final :
+		public osink
+	{
+	public:
+		memory_sink() noexcept = default;
+
+		explicit inline memory_sink(std::size_t a_capacity) { _buffer.reserve(a_capacity); }
+
+		inline void write(stl::span<const stl::byte> a_data) override
+		{
+			_buffer.insert(_buffer.end(), a_data.begin(), a_data.end());
+		}
+
+		BSA_NODISCARD inline stl::span<const stl::byte> span() const noexcept { return { _buffer.data(), _buffer.size() }; }
+		BSA_NODISCARD inline std::size_t size() const noexcept { return _buffer.size(); }
+
+		inline void clear() noexcept { _buffer.clear(); }
+
+		// hands over the buffer, leaving the sink empty
+		BSA_NODISCARD inline std::vector<stl::byte> release() noexcept
+		{
+			auto result = std::move(_buffer);
+			_buffer.clear();
+			return result;
+		}
+
+	private:
+		std::vector<stl::byte> _buffer;
+	};
+
+#ifdef __linux__
+	// writes straight to an open file descriptor, which remains owned by the caller
+	class fd_sink final :
+		public osink
+	{
+	public:
+		explicit constexpr fd_sink(int a_fd) noexcept :
+			_fd(a_fd)
+		{}
+
+		inline void write(stl::span<const stl::byte> a_data) override
+		{
+			auto src = reinterpret_cast<const char*>(a_data.data());
+			auto left = a_data.size();
+			while (left > 0) {
+				const auto written = ::write(_fd, src, left);
+				if (written == -1) {
+					if (errno == EINTR) {
+						continue;
+					}
+					throw output_error("failed to write output file");
+				}
+				src += written;
+				left -= static_cast<std::size_t>(written);
+			}
+		}
+
+		BSA_NODISCARD constexpr int fd() const noexcept { return _fd; }
+
+	private:
+		int _fd;
+	};
+#endif
+
 	namespace detail
 	{
 		// sign extending cast
@@ -395,6 +586,332 @@ namespace bsa
 			big
 		};
 
+		BSA_CXX17_INLINE constexpr auto native_endian{
+			boost::endian::order::native == boost::endian::order::little ?
+				  endian::little :
+				  endian::big
+		};
+
+		// decodes an integer of the given endianness from unaligned storage,
+		// only swapping the bytes when the archive disagrees with the host
+		template <
+			class T,
+			stl::enable_if_t<
+				stl::disjunction_v<
+					std::is_integral<T>,
+					std::is_enum<T>>,
+				int> = 0>
+		BSA_NODISCARD inline T load(observer<const stl::byte*> a_src, endian a_endian) noexcept
+		{
+			using integer_t = stl::make_unsigned_t<T>;
+
+			integer_t tmp{ 0 };
+			std::memcpy(std::addressof(tmp), a_src, sizeof(T));
+			if (a_endian != native_endian) {
+				tmp = boost::endian::endian_reverse(tmp);
+			}
+
+			return zero_extend<T>(tmp);
+		}
+
+		// the hashers refuse anything outside of ascii, and checking one char at a time with an
+		// early out costs about as much as the hash itself
+		BSA_NODISCARD inline bool is_ascii(stl::string_view a_string) noexcept
+		{
+#ifdef BSA_HAS_SSE2
+			if (a_string.size() >= 16) {
+				const auto load = [&](std::size_t a_pos) noexcept {
+					return _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_string.data() + a_pos));
+				};
+
+				// the last load overlaps whatever the loop already covered
+				auto acc = load(a_string.size() - 16);
+				for (std::size_t pos = 0; pos + 16 < a_string.size(); pos += 16) {
+					acc = _mm_or_si128(acc, load(pos));
+				}
+				return _mm_movemask_epi8(acc) == 0;
+			}
+#endif
+			unsigned char bits = 0;
+			for (const auto& ch : a_string) {
+				bits |= static_cast<unsigned char>(ch);
+			}
+			return (bits & 0x80) == 0;
+		}
+
+		// what map_path saw while mapping a path
+		struct path_scan_t
+		{
+			bool dirty{ false };  // a segment is empty or starts with a dot
+			std::size_t lastSep{ stl::string_view::npos };
+			std::size_t lastDot{ stl::string_view::npos };
+		};
+
+		// applies mapchar to the a_count chars of a path, a_src and a_dst may be the same. mapchar
+		// rebuilds its table on every call outside of constant evaluation, so this spells the
+		// mapping out
+		inline path_scan_t map_path(observer<const char*> a_src, observer<char*> a_dst, std::size_t a_count) noexcept
+		{
+			path_scan_t scan;
+			if (a_count == 0) {
+				return scan;
+			}
+
+#ifdef BSA_HAS_SSE2
+			unsigned carry = 1;	 // the start of the path begins a segment
+			unsigned flagged = 0;
+			const auto highest = [](unsigned a_mask) noexcept {
+				return static_cast<std::size_t>(31 - stl::countl_zero(a_mask));
+			};
+
+			// maps 16 chars starting at a_pos, of which only those in a_fresh are new. mapping is
+			// idempotent, so the tail can overlap chars that were already done
+			const auto map = [&](std::size_t a_pos, __m128i a_in, unsigned a_fresh) noexcept {
+				// chars past 0x7F compare as negative, so only 'A'-'Z' land in the range
+				const auto upper = _mm_and_si128(
+					_mm_cmpgt_epi8(a_in, _mm_set1_epi8('A' - 1)),
+					_mm_cmplt_epi8(a_in, _mm_set1_epi8('Z' + 1)));
+				const auto slash = _mm_cmpeq_epi8(a_in, _mm_set1_epi8('/'));
+				const auto backslash = _mm_cmpeq_epi8(a_in, _mm_set1_epi8('\\'));
+				const auto dot = _mm_cmpeq_epi8(a_in, _mm_set1_epi8('.'));
+
+				const auto seps = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(slash, backslash)));
+				const auto dots = static_cast<unsigned>(_mm_movemask_epi8(dot));
+				flagged |= (seps | dots) & ((seps << 1) | carry) & a_fresh;
+				carry = (seps >> 15) & 1;
+				if ((seps & a_fresh) != 0) {
+					scan.lastSep = a_pos + highest(seps & a_fresh);
+				}
+				if ((dots & a_fresh) != 0) {
+					scan.lastDot = a_pos + highest(dots & a_fresh);
+				}
+
+				const auto out = _mm_add_epi8(a_in, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A')));
+				return _mm_or_si128(
+					_mm_andnot_si128(slash, out),
+					_mm_and_si128(slash, _mm_set1_epi8('\\')));
+			};
+
+			if (a_count < 16) {
+				alignas(16) char tmp[16] = {};
+				std::memcpy(tmp, a_src, a_count);
+				const auto in = _mm_load_si128(reinterpret_cast<const __m128i*>(tmp));
+				_mm_store_si128(reinterpret_cast<__m128i*>(tmp), map(0, in, (1u << a_count) - 1));
+				std::memcpy(a_dst, tmp, a_count);
+			} else {
+				std::size_t i = 0;
+				for (; i + 16 <= a_count; i += 16) {
+					const auto in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_src + i));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(a_dst + i), map(i, in, 0xFFFF));
+				}
+
+				if (i < a_count) {
+					const auto pos = a_count - 16;
+					const auto in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_src + pos));
+					const auto fresh = 0xFFFFu & ~((1u << (i - pos)) - 1);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(a_dst + pos), map(pos, in, fresh));
+				}
+			}
+
+			scan.dirty = flagged != 0;
+#else
+			bool boundary = true;
+			for (std::size_t i = 0; i < a_count; ++i) {
+				auto ch = a_src[i];
+				if (ch >= 'A' && ch <= 'Z') {
+					ch = static_cast<char>(ch + ('a' - 'A'));
+				} else if (ch == '/') {
+					ch = '\\';
+				}
+				a_dst[i] = ch;
+
+				const auto sep = ch == '\\';
+				if (sep) {
+					scan.lastSep = i;
+				} else if (ch == '.') {
+					scan.lastDot = i;
+				}
+				scan.dirty = scan.dirty || (boundary && (sep || ch == '.'));
+				boundary = sep;
+			}
+#endif
+
+			scan.dirty = scan.dirty || a_dst[a_count - 1] == '\\';
+			return scan;
+		}
+
+		// the pieces of a path written by normalize_path, as views into its buffer
+		struct path_parts_t
+		{
+			stl::string_view full;
+			stl::string_view parent;
+			stl::string_view filename;
+			stl::string_view stem;
+			stl::string_view extension;	 // includes the dot
+		};
+
+		// a_sep and a_dot are the positions of the last separator and dot in a_full, or npos
+		BSA_NODISCARD constexpr path_parts_t split_path(stl::string_view a_full, std::size_t a_sep, std::size_t a_dot) noexcept
+		{
+			path_parts_t parts;
+			parts.full = a_full;
+
+			if (a_sep != stl::string_view::npos) {
+				parts.parent = a_full.substr(0, a_sep);
+				parts.filename = a_full.substr(a_sep + 1);
+			} else {
+				parts.filename = a_full;
+			}
+
+			if (a_dot == stl::string_view::npos ||
+				(a_sep != stl::string_view::npos && a_dot < a_sep) ||
+				parts.filename == "..") {
+				parts.stem = parts.filename;
+			} else {
+				const auto dot = a_sep != stl::string_view::npos ? a_dot - a_sep - 1 : a_dot;
+				parts.stem = parts.filename.substr(0, dot);
+				parts.extension = parts.filename.substr(dot);
+			}
+
+			return parts;
+		}
+
+		// drops empty and "." segments from the a_count mapped chars at a_buf and resolves ".."
+		// against the segment before it, leaving no leading or trailing separator
+		BSA_NODISCARD constexpr path_parts_t compact_path(char* a_buf, std::size_t a_count) noexcept
+		{
+			// segments only ever move towards the front, so this compacts in place
+			std::size_t len = 0;
+			std::size_t i = 0;
+			while (i < a_count) {
+				while (i < a_count && a_buf[i] == '\\') {
+					++i;
+				}
+				auto j = i;
+				while (j < a_count && a_buf[j] != '\\') {
+					++j;
+				}
+
+				const stl::string_view segment{ a_buf + i, j - i };
+				if (segment.empty() || segment == ".") {
+					// skip
+				} else if (segment == "..") {
+					const stl::string_view written{ a_buf, len };
+					const auto pos = written.find_last_of('\\');
+					const auto last = pos != stl::string_view::npos ? written.substr(pos + 1) : written;
+					if (!last.empty() && last != "..") {
+						len = pos != stl::string_view::npos ? pos : 0;
+					} else {
+						if (len > 0) {
+							a_buf[len++] = '\\';
+						}
+						a_buf[len++] = '.';
+						a_buf[len++] = '.';
+					}
+				} else {
+					if (len > 0) {
+						a_buf[len++] = '\\';
+					}
+					for (std::size_t k = 0; k < segment.size(); ++k) {
+						a_buf[len++] = a_buf[i + k];
+					}
+				}
+
+				i = j;
+			}
+
+			const stl::string_view full{ a_buf, len };
+			return split_path(full, full.find_last_of('\\'), full.find_last_of('.'));
+		}
+
+		// lowercases a_path and converts its separators to backslashes, then compacts it. the
+		// result is never longer than a_path, so a_out must hold at least that much
+		inline path_parts_t normalize_path(stl::string_view a_path, stl::span<char> a_out) noexcept
+		{
+			assert(a_out.size() >= a_path.size());
+			const auto buf = a_out.data();
+			const auto n = a_path.size();
+			const auto scan = map_path(a_path.data(), buf, n);
+			return !scan.dirty ?
+				split_path({ buf, n }, scan.lastSep, scan.lastDot) :
+				compact_path(buf, n);
+		}
+
+		// scratch space for normalize_path, which only touches the heap for unreasonably long paths
+		class path_buffer_t final
+		{
+		public:
+			explicit inline path_buffer_t(std::size_t a_size) :
+				_size(a_size)
+			{
+				if (a_size > _stack.size()) {
+					_heap.reset(new char[a_size]);
+				}
+			}
+
+			path_buffer_t(const path_buffer_t&) = delete;
+			path_buffer_t(path_buffer_t&&) = delete;
+
+			~path_buffer_t() noexcept = default;
+
+			path_buffer_t& operator=(const path_buffer_t&) = delete;
+			path_buffer_t& operator=(path_buffer_t&&) = delete;
+
+			BSA_NODISCARD inline stl::span<char> get() noexcept
+			{
+				return { _heap ? _heap.get() : _stack.data(), _size };
+			}
+
+		private:
+			std::array<char, 512> _stack;
+			std::unique_ptr<char[]> _heap;
+			std::size_t _size{ 0 };
+		};
+
+		// normalizes a_path into a buffer that outlives the returned views
+		BSA_NODISCARD inline path_parts_t normalize_path(stl::string_view a_path, path_buffer_t& a_buffer) noexcept
+		{
+			return normalize_path(a_path, a_buffer.get());
+		}
+
+		// normalize_path for a path that is known at compile time, for hashes that can be worked
+		// out ahead of time. it maps one char at a time, so it's no use at runtime
+		class static_path_t final
+		{
+		public:
+			explicit constexpr static_path_t(stl::string_view a_path) :
+				_buffer{}
+			{
+				if (a_path.size() > _buffer.size()) {
+					throw hash_error("path is too long to hash at compile time");
+				}
+
+				for (std::size_t i = 0; i < a_path.size(); ++i) {
+					if (a_path[i] < 0) {
+						throw hash_non_ascii();
+					}
+					_buffer[i] = mapchar(a_path[i]);
+				}
+
+				_parts = compact_path(_buffer.data(), a_path.size());
+			}
+
+			// the parts point into the buffer
+			static_path_t(const static_path_t&) = delete;
+			static_path_t(static_path_t&&) = delete;
+
+			~static_path_t() noexcept = default;
+
+			static_path_t& operator=(const static_path_t&) = delete;
+			static_path_t& operator=(static_path_t&&) = delete;
+
+			BSA_NODISCARD constexpr const path_parts_t& parts() const noexcept { return _parts; }
+
+		private:
+			std::array<char, 512> _buffer;
+			path_parts_t _parts;
+		};
+
 		class path_t final
 		{
 		public:
@@ -450,29 +967,77 @@ namespace bsa
 		private:
 			inline void normalize(const boost::filesystem::path& a_path)
 			{
-				_impl = a_path.lexically_normal().string();
+				auto&& str = a_path.string();
+				_impl.resize(str.size());
+				const auto parts = normalize_path(str, { _impl.data(), _impl.size() });
+				_impl.resize(parts.full.size());
+			}
 
-				for (auto& ch : _impl) {
-					ch = mapchar(ch);
-				}
+			value_type _impl;
+		};
 
-				if (!_impl.empty() && _impl.back() == '\\') {
-					_impl.pop_back();
-				}
+		// names read from an archive are views into its mapping, which the archive's index keeps
+		// alive, so only the names a caller supplies are ever copied. views of zstrings keep
+		// their terminator, so c_str() is only valid for those and for owned names
+		class name_t final
+		{
+		public:
+			name_t() noexcept = default;
+			name_t(const name_t&) = default;
+			name_t(name_t&&) noexcept = default;
+
+			explicit inline name_t(std::string a_name) noexcept :
+				_impl(std::move(a_name))
+			{}
+
+			~name_t() = default;
+
+			name_t& operator=(const name_t&) = default;
+			name_t& operator=(name_t&&) noexcept = default;
+
+			BSA_NODISCARD inline const char* c_str() const noexcept { return data(); }
 
-				if (!_impl.empty() && _impl.front() == '\\') {
-					_impl = _impl.substr(1);
+			// never null, even for a name that was never assigned
+			BSA_NODISCARD inline const char* data() const noexcept
+			{
+				if (_impl.index() == iview) {
+					const auto data = stl::get<iview>(_impl).data();
+					return data ? data : "";
+				} else {
+					return stl::get<iowned>(_impl).c_str();
 				}
 			}
 
-			value_type _impl;
+			BSA_NODISCARD inline bool empty() const noexcept { return size() == 0; }
+
+			BSA_NODISCARD inline std::size_t size() const noexcept
+			{
+				return _impl.index() == iview ?
+						   stl::get<iview>(_impl).size() :
+						   stl::get<iowned>(_impl).size();
+			}
+
+			BSA_NODISCARD inline std::string str() const { return std::string(data(), size()); }
+			BSA_NODISCARD inline stl::string_view view() const noexcept { return { data(), size() }; }
+
+			inline void assign(std::string a_name) noexcept { _impl.emplace<iowned>(std::move(a_name)); }
+			inline void assign_view(stl::string_view a_name) noexcept { _impl.emplace<iview>(a_name); }
+
+		private:
+			enum : std::size_t
+			{
+				iview,
+				iowned
+			};
+
+			stl::variant<stl::string_view, std::string> _impl;
 		};
 
-		class istream_t final
+		// a cursor over a block of the input which has already been bounds checked,
+		// used to decode fixed-layout record tables in a single pass
+		class ispan_t final
 		{
 		public:
-			using stream_type = boost::iostreams::mapped_file_source;
-
 			using value_type = const stl::byte;
 			using size_type = std::size_t;
 			using difference_type = std::ptrdiff_t;
@@ -481,59 +1046,25 @@ namespace bsa
 			using reference = value_type&;
 			using const_reference = stl::add_const_t<value_type>&;
 
-			inline istream_t() noexcept :
-				_stream(),
+			inline ispan_t() noexcept :
+				_span(),
 				_pos(0),
 				_endian(endian::little)
 			{}
 
-			inline istream_t(const istream_t& a_rhs) noexcept :
-				_stream(a_rhs._stream),
-				_pos(a_rhs._pos),
-				_endian(a_rhs._endian)
-			{}
-
-			inline istream_t(istream_t&& a_rhs) noexcept :
-				_stream(std::move(a_rhs._stream)),
-				_pos(std::move(a_rhs._pos)),
-				_endian(std::move(a_rhs._endian))
-			{}
+			ispan_t(const ispan_t&) noexcept = default;
+			ispan_t(ispan_t&&) noexcept = default;
 
-			inline istream_t(stream_type a_stream) :
-				_stream(std::move(a_stream)),
+			inline ispan_t(stl::span<value_type> a_span, endian a_endian) noexcept :
+				_span(a_span),
 				_pos(0),
-				_endian(endian::little)
+				_endian(a_endian)
 			{}
 
-			inline istream_t(const boost::filesystem::path& a_path) :
-				_stream(),
-				_pos(0),
-				_endian(endian::little)
-			{
-				open(a_path);
-			}
-
-			~istream_t() noexcept = default;
-
-			inline istream_t& operator=(const istream_t& a_rhs) noexcept
-			{
-				if (this != std::addressof(a_rhs)) {
-					_stream = a_rhs._stream;
-					_pos = a_rhs._pos;
-					_endian = a_rhs._endian;
-				}
-				return *this;
-			}
+			~ispan_t() noexcept = default;
 
-			inline istream_t& operator=(istream_t&& a_rhs) noexcept
-			{
-				if (this != std::addressof(a_rhs)) {
-					_stream = std::move(a_rhs._stream);
-					_pos = std::move(a_rhs._pos);
-					_endian = std::move(a_rhs._endian);
-				}
-				return *this;
-			}
+			ispan_t& operator=(const ispan_t&) noexcept = default;
+			ispan_t& operator=(ispan_t&&) noexcept = default;
 
 			template <
 				class T,
@@ -542,74 +1073,52 @@ namespace bsa
 						std::is_integral<T>,
 						std::is_enum<T>>,
 					int> = 0>
-			inline istream_t& operator>>(T& a_value)
+			inline ispan_t& operator>>(T& a_value) noexcept
 			{
-				using integer_t =
-					std::conditional_t<
-						(sizeof(T) > sizeof(std::size_t)),
-						stl::make_unsigned_t<T>,
-						std::size_t>;
-				integer_t tmp{ 0 };
-
-				switch (_endian) {
-				case endian::little:
-					for (std::size_t i = 0; i < sizeof(T); ++i) {
-						tmp |= ref<integer_t>(_pos++) << i * byte_v;
-					}
-					break;
-				case endian::big:
-					for (auto i = zero_extend<std::ptrdiff_t>(sizeof(T)) - 1; i >= 0; --i) {
-						tmp |= ref<integer_t>(_pos++) << i * byte_v;
-					}
-					break;
-				default:
-					throw input_error();
-				}
-
-				a_value = zero_extend<T>(tmp);
+				assert(_pos + sizeof(T) <= size());
+				a_value = load<T>(_span.data() + _pos, _endian);
+				_pos += sizeof(T);
 				return *this;
 			}
 
 			template <std::size_t N>
-			inline istream_t& operator>>(std::array<char, N>& a_value)
+			inline ispan_t& operator>>(std::array<char, N>& a_value) noexcept
 			{
 				read(a_value.begin(), a_value.size());
 				return *this;
 			}
 
-			constexpr istream_t& operator>>(endian a_endian) noexcept
+			constexpr ispan_t& operator>>(endian a_endian) noexcept
 			{
 				_endian = a_endian;
 				return *this;
 			}
 
-			BSA_NODISCARD inline bool operator!() const { return !is_open(); }
-			BSA_NODISCARD explicit inline operator bool() const { return is_open(); }
-
-			inline void get(char& a_ch)
+			inline void get(char& a_ch) noexcept
 			{
-				a_ch = ref<char>(_pos++);
+				assert(_pos < size());
+				a_ch = zero_extend<char>(*(_span.data() + _pos++));
 			}
 
 			template <class OutputIt>
 			inline void read(OutputIt a_dst, size_type a_count)
 			{
 				assert(_pos + a_count <= size());
-				std::copy_n(reinterpret_cast<const char*>(ptr(_pos)), a_count, a_dst);
+				std::copy_n(reinterpret_cast<const char*>(_span.data() + _pos), a_count, a_dst);
 				_pos += a_count;
 			}
 
-			BSA_NODISCARD constexpr size_type tell() const noexcept { return _pos; }
-
-			// seek absolute position
-			inline void seek_abs(size_type a_pos) noexcept
+			// views a_count bytes in place and steps over them
+			BSA_NODISCARD inline stl::string_view read_view(size_type a_count) noexcept
 			{
-				assert(a_pos < size());
-				_pos = a_pos;
+				assert(_pos + a_count <= size());
+				const stl::string_view result{ reinterpret_cast<const char*>(_span.data() + _pos), a_count };
+				_pos += a_count;
+				return result;
 			}
 
-			constexpr void seek_beg() noexcept { _pos = 0; }					 // seek to beginning
-			inline void seek_beg(size_type a_pos) noexcept { seek_abs(a_pos); }	 // seek from beginning
+			BSA_NODISCARD inline size_type size() const noexcept { return _span.size(); }
+			BSA_NODISCARD constexpr size_type tell() const noexcept { return _pos; }
 
 			// seek relative to current position
 			template <
@@ -621,298 +1130,2701 @@ namespace bsa
 					int> = 0>
 			inline void seek_rel(T a_off) noexcept
 			{
-				assert(_pos + a_off < size());
+				assert(_pos + a_off <= size());
 				_pos += a_off;
 			}
 
-			BSA_NODISCARD inline bool is_open() const { return _stream.is_open(); }
+		private:
+			stl::span<value_type> _span;
+			size_type _pos;
+			endian _endian;
+		};
+
+		enum class access_hint
+		{
+			normal,
+			sequential,
+			random,
+			willneed
+		};
+
+		// the storage behind an istream_t
+		class source_t
+		{
+		public:
+			source_t() noexcept = default;
+			source_t(const source_t&) = delete;
+			source_t(source_t&&) = delete;
+
+			virtual ~source_t() = default;
+
+			source_t& operator=(const source_t&) = delete;
+			source_t& operator=(source_t&&) = delete;
 
-			inline void open(const boost::filesystem::path& a_path)
+			// the file the data was read from, if any. device and inode tell whether the file
+			// at path is still the one that was read
+			struct origin_t
 			{
-				auto fail = false;
-				try {
-					_stream.open(a_path);
-				} catch (...) {
-					fail = true;
+				boost::filesystem::path path;
+				std::uint64_t device{ 0 };
+				std::uint64_t inode{ 0 };
+			};
+
+			BSA_NODISCARD virtual stl::span<const stl::byte> data() const noexcept = 0;
+
+			// tells the backend how [a_offset, a_offset + a_count) is about to be read
+			virtual void advise(access_hint, std::size_t, std::size_t) const noexcept {}
+
+			// true when data() is already in memory, rather than paged in as it's touched
+			BSA_NODISCARD virtual bool resident() const noexcept { return false; }
+
+			BSA_NODISCARD inline const origin_t& origin() const noexcept { return _origin; }
+
+		protected:
+			inline void origin(const boost::filesystem::path& a_path) noexcept
+			{
+#ifdef __linux__
+				struct ::stat st;
+				if (::stat(a_path.c_str(), &st) == 0) {
+					_origin.path = a_path;
+					_origin.device = static_cast<std::uint64_t>(st.st_dev);
+					_origin.inode = static_cast<std::uint64_t>(st.st_ino);
 				}
+#else
+				_origin.path = a_path;
+#endif
+			}
+
+		private:
+			origin_t _origin;
+		};
+
+		class mapped_source final :
+			public source_t
+		{
+		public:
+			using stream_type = boost::iostreams::mapped_file_source;
 
-				if (fail || !is_open()) {
+			explicit inline mapped_source(stream_type a_file) :
+				_file(std::move(a_file))
+			{
+				if (!_file.is_open()) {
 					throw input_error();
 				}
 			}
 
-			inline void close() { _stream.close(); }
-
-			BSA_NODISCARD inline size_type size() const noexcept
+			explicit inline mapped_source(const boost::filesystem::path& a_path) :
+				_file()
 			{
+				auto fail = false;
 				try {
-					return _stream.size();
+					_file.open(a_path);
 				} catch (...) {
-					return 0;
+					fail = true;
 				}
-			}
 
-			inline stl::span<value_type> subspan() const { return subspan(size()); }
-			inline stl::span<value_type> subspan(size_type a_count) const { return subspan(_pos, a_count); }
+				if (fail || !_file.is_open()) {
+					throw input_error();
+				}
 
-			inline stl::span<value_type> subspan(size_type a_offset, size_type a_count) const
-			{
-				assert(a_offset + a_count <= size());
-				return { ptr(a_offset), a_count };
+				origin(a_path);
 			}
 
-		private:
-			BSA_NODISCARD inline observer<pointer> data() const
+			BSA_NODISCARD inline stl::span<const stl::byte> data() const noexcept override
 			{
-				assert(is_open());
-				return reinterpret_cast<pointer>(_stream.data());
+				return { reinterpret_cast<const stl::byte*>(_file.data()), _file.size() };
 			}
 
-			BSA_NODISCARD inline observer<pointer> fetch(size_type a_pos) const
+			inline void advise(access_hint a_hint, std::size_t a_offset, std::size_t a_count) const noexcept override
 			{
-				assert(a_pos < size());
-				return data() + a_pos;
-			}
+#ifdef __linux__
+				const auto size = _file.size();
+				if (a_offset >= size) {
+					return;
+				}
+				a_count = (std::min)(a_count, size - a_offset);
 
-			BSA_NODISCARD inline observer<pointer> ptr(size_type a_pos) const { return fetch(a_pos); }
-			BSA_NODISCARD inline reference ref(size_type a_pos) const { return *fetch(a_pos); }
+				int advice = MADV_NORMAL;
+				switch (a_hint) {
+				case access_hint::sequential:
+					advice = MADV_SEQUENTIAL;
+					break;
+				case access_hint::random:
+					advice = MADV_RANDOM;
+					break;
+				case access_hint::willneed:
+					advice = MADV_WILLNEED;
+					break;
+				case access_hint::normal:
+				default:
+					break;
+				}
 
-			template <
-				class T,
-				stl::enable_if_t<
-					stl::disjunction_v<
-						std::is_integral<T>,
-						std::is_enum<T>>,
-					int> = 0>
-			BSA_NODISCARD inline T ref(size_type a_pos) const
-			{
-				return zero_extend<T>(ref(a_pos));
+				// madvise wants a page aligned address, and the mapping itself is one
+				const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+				const auto first = a_offset - a_offset % page;
+				const auto base = const_cast<char*>(_file.data());
+				::madvise(base + first, a_count + (a_offset - first), advice);	// only a hint
+#else
+				(void)a_hint;
+				(void)a_offset;
+				(void)a_count;
+#endif
 			}
 
-			stream_type _stream;
-			size_type _pos;
-			endian _endian;
+		private:
+			stream_type _file;
 		};
 
-		class ostream_t final
+		// the whole file read into an owned buffer. with a_direct, the reads go around the
+		// page cache, which is left alone for other processes during bulk scans
+		class buffered_source final :
+			public source_t
 		{
 		public:
-			using stream_type = std::ostream;
-			using reference = stream_type&;
-			using const_reference = const stream_type&;
-			using pointer = stream_type*;
-			using const_pointer = const stream_type*;
-			using char_type = typename stream_type::char_type;
-			using pos_type = typename stream_type::pos_type;
-			using off_type = typename stream_type::off_type;
+			inline buffered_source(const boost::filesystem::path& a_path, bool a_direct) :
+				_buffer(),
+				_size(0)
+			{
+#ifdef __linux__
+				constexpr std::size_t alignment = 1u << 12;	 // satisfies O_DIRECT on any block size in use
+				constexpr std::size_t chunk = 1u << 24;
+
+				auto direct = a_direct;
+				auto fd = direct ? ::open(a_path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT) : -1;
+				if (fd == -1) {	 // not every filesystem supports O_DIRECT
+					direct = false;
+					fd = ::open(a_path.c_str(), O_RDONLY | O_CLOEXEC);
+				}
+				if (fd == -1) {
+					throw input_error("failed to open input file");
+				}
 
-			inline ostream_t() = delete;
-			inline ostream_t(const ostream_t&) = delete;
-			inline ostream_t(ostream_t&&) = delete;
+				try {
+					struct ::stat st;
+					if (::fstat(fd, &st) == -1) {
+						throw input_error("failed to open input file");
+					}
+					_size = static_cast<std::size_t>(st.st_size);
 
-			inline ostream_t(stream_type& a_stream) :
-				_stream(a_stream),
-				_beg(a_stream.tellp()),
-				_endian(endian::little)
-			{
-				if (!_stream) {
-					throw output_error();
-				} else {
-					_stream.exceptions(std::ios_base::badbit | std::ios_base::failbit);
-					_stream.flags(std::ios_base::dec);
+					// whole pages, so that O_DIRECT may always read full blocks
+					const auto capacity = (std::max)((_size + alignment - 1) / alignment * alignment, alignment);
+					void* buffer = nullptr;
+					if (::posix_memalign(&buffer, alignment, capacity) != 0) {
+						throw std::bad_alloc();
+					}
+					_buffer.reset(static_cast<stl::byte*>(buffer));
+
+					std::size_t pos = 0;
+					while (pos < _size) {
+						const auto count = (std::min)(capacity - pos, chunk);
+						const auto read = ::pread(fd, _buffer.get() + pos, count, static_cast<::off_t>(pos));
+						if (read == -1) {
+							if (errno == EINTR) {
+								continue;
+							} else if (errno == EINVAL && direct) {	 // the device wants a stricter alignment
+								direct = false;
+								::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_DIRECT);
+								continue;
+							}
+							throw input_error("failed to read input file");
+						} else if (read == 0) {
+							throw input_error("input file was truncated while reading");
+						}
+						pos += static_cast<std::size_t>(read);
+					}
+				} catch (...) {
+					::close(fd);
+					throw;
 				}
-			}
 
-			ostream_t& operator=(const ostream_t&) = delete;
-			ostream_t& operator=(ostream_t&&) = delete;
+				::close(fd);
+#else
+				(void)a_direct;
 
-			template <
-				class T,
-				stl::enable_if_t<
-					stl::disjunction_v<
-						std::is_integral<T>,
-						std::is_enum<T>>,
-					int> = 0>
-			inline ostream_t& operator<<(T a_value)
-			{
-				using integer_t =
-					std::conditional_t<
-						(sizeof(T) > sizeof(unsigned int)),
-						stl::make_unsigned_t<T>,
-						unsigned int>;
-				constexpr auto MASK =
-					zero_extend<std::size_t>(
-						(std::numeric_limits<std::uint8_t>::max)());
+				std::ifstream input{ a_path.native(), std::ios_base::in | std::ios_base::binary | std::ios_base::ate };
+				if (!input.is_open()) {
+					throw input_error("failed to open input file");
+				}
 
-				const auto value = zero_extend<integer_t>(a_value);
-				std::array<stl::byte, sizeof(T)> buf;
-				auto it = buf.begin();
+				_size = static_cast<std::size_t>(input.tellg());
+				_buffer.reset(static_cast<stl::byte*>(std::malloc((std::max)(_size, std::size_t{ 1 }))));
+				if (!_buffer) {
+					throw std::bad_alloc();
+				}
 
-				switch (_endian) {
-				case endian::little:
-					for (std::size_t i = 0; i < sizeof(T); ++i) {
-						*it++ = zero_extend<stl::byte>((value >> i * byte_v) & MASK);
-					}
-					break;
-				case endian::big:
-					for (auto i = zero_extend<std::ptrdiff_t>(sizeof(T)) - 1; i >= 0; --i) {
-						*it++ = zero_extend<stl::byte>((value >> i * byte_v) & MASK);
-					}
-					break;
-				default:
-					throw output_error();
+				input.seekg(0);
+				input.read(reinterpret_cast<char*>(_buffer.get()), static_cast<std::streamsize>(_size));
+				if (!input) {
+					throw input_error("failed to read input file");
 				}
+#endif
 
-				return *this << buf;
+				origin(a_path);
 			}
 
-			inline ostream_t& operator<<(char a_value)
+			BSA_NODISCARD inline stl::span<const stl::byte> data() const noexcept override
 			{
-				return write(std::addressof(a_value), 1);
+				return { _buffer.get(), _size };
 			}
 
-			template <std::size_t N>
-			inline ostream_t& operator<<(const std::array<stl::byte, N>& a_value)
-			{
-				return write(
-					reinterpret_cast<const char*>(a_value.data()),
-					zero_extend<std::streamsize>(a_value.size()));
-			}
+			BSA_NODISCARD inline bool resident() const noexcept override { return true; }
 
-			template <std::size_t N>
-			inline ostream_t& operator<<(const std::array<char_type, N>& a_value)
+		private:
+			struct free_deleter
 			{
-				return write(a_value.data(), zero_extend<std::streamsize>(a_value.size()));
-			}
+				inline void operator()(stl::byte* a_ptr) const noexcept { std::free(a_ptr); }
+			};
 
-			inline ostream_t& operator<<(stl::span<stl::byte> a_value)
-			{
-				return write(
-					reinterpret_cast<const char*>(a_value.data()),
-					zero_extend<std::streamsize>(a_value.size()));
-			}
+			std::unique_ptr<stl::byte, free_deleter> _buffer;
+			std::size_t _size;
+		};
 
-			inline ostream_t& operator<<(stl::span<const stl::byte> a_value)
-			{
-				return write(
-					reinterpret_cast<const char*>(a_value.data()),
-					zero_extend<std::streamsize>(a_value.size()));
-			}
+		class istream_t final
+		{
+		public:
+			using stream_type = boost::iostreams::mapped_file_source;
 
-			inline ostream_t& operator<<(stl::span<char_type> a_value)
-			{
-				return write(a_value.data(), zero_extend<std::streamsize>(a_value.size()));
-			}
+			using value_type = const stl::byte;
+			using size_type = std::size_t;
+			using difference_type = std::ptrdiff_t;
+			using pointer = value_type*;
+			using const_pointer = stl::add_const_t<value_type>*;
+			using reference = value_type&;
+			using const_reference = stl::add_const_t<value_type>&;
 
-			inline ostream_t& operator<<(stl::span<const char_type> a_value)
-			{
-				return write(a_value.data(), zero_extend<std::streamsize>(a_value.size()));
-			}
+			inline istream_t() noexcept :
+				_source(),
+				_data(),
+				_pos(0),
+				_endian(endian::little)
+			{}
 
-			inline ostream_t& operator<<(stl::basic_string_view<char_type> a_value)
+			inline istream_t(const istream_t& a_rhs) noexcept :
+				_source(a_rhs._source),
+				_data(a_rhs._data),
+				_pos(a_rhs._pos),
+				_endian(a_rhs._endian)
+			{}
+
+			inline istream_t(istream_t&& a_rhs) noexcept :
+				_source(std::move(a_rhs._source)),
+				_data(std::exchange(a_rhs._data, {})),
+				_pos(std::move(a_rhs._pos)),
+				_endian(std::move(a_rhs._endian))
+			{}
+
+			inline istream_t(stream_type a_stream) :
+				_source(std::make_shared<mapped_source>(std::move(a_stream))),
+				_data(_source->data()),
+				_pos(0),
+				_endian(endian::little)
+			{}
+
+			inline istream_t(const boost::filesystem::path& a_path, io_backend a_backend = io_backend::mmap) :
+				_source(),
+				_data(),
+				_pos(0),
+				_endian(endian::little)
 			{
-				return write(a_value.data(), zero_extend<std::streamsize>(a_value.size()));
+				open(a_path, a_backend);
 			}
 
-			constexpr ostream_t& operator<<(endian a_endian) noexcept
+			~istream_t() noexcept = default;
+
+			inline istream_t& operator=(const istream_t& a_rhs) noexcept
 			{
-				_endian = a_endian;
+				if (this != std::addressof(a_rhs)) {
+					_source = a_rhs._source;
+					_data = a_rhs._data;
+					_pos = a_rhs._pos;
+					_endian = a_rhs._endian;
+				}
 				return *this;
 			}
 
-			BSA_NODISCARD inline bool operator!() const { return !_stream; }
-			BSA_NODISCARD explicit inline operator bool() const { return static_cast<bool>(_stream); }
-
-			inline ostream_t& write(observer<const char_type*> a_str, std::streamsize a_count)
+			inline istream_t& operator=(istream_t&& a_rhs) noexcept
 			{
-				if (a_count > 0) {
-					_stream.write(a_str, a_count);
+				if (this != std::addressof(a_rhs)) {
+					_source = std::move(a_rhs._source);
+					_data = std::exchange(a_rhs._data, {});
+					_pos = std::move(a_rhs._pos);
+					_endian = std::move(a_rhs._endian);
 				}
 				return *this;
 			}
 
-			BSA_NODISCARD inline pos_type tell() { return _stream.tellp(); }
-			BSA_NODISCARD inline pos_type tell_rel() { return tell() - _beg; }
-
-			// seek absolute position
-			inline ostream_t& seek_abs(pos_type a_pos)
+			template <
+				class T,
+				stl::enable_if_t<
+					stl::disjunction_v<
+						std::is_integral<T>,
+						std::is_enum<T>>,
+					int> = 0>
+			inline istream_t& operator>>(T& a_value)
 			{
-				_stream.seekp(a_pos);
+				assert(_pos + sizeof(T) <= size());
+				a_value = load<T>(ptr(_pos), _endian);
+				_pos += sizeof(T);
 				return *this;
 			}
 
-			// seek to beginning
-			inline ostream_t& seek_beg()
+			template <std::size_t N>
+			inline istream_t& operator>>(std::array<char, N>& a_value)
 			{
-				_stream.seekp(_beg);
+				read(a_value.begin(), a_value.size());
 				return *this;
 			}
 
-			// seek from beginning
-			inline ostream_t& seek_beg(pos_type a_pos)
+			constexpr istream_t& operator>>(endian a_endian) noexcept
 			{
-				_stream.seekp(_beg + a_pos);
+				_endian = a_endian;
 				return *this;
 			}
 
-			// seek relative to current position
-			inline ostream_t& seek_rel(off_type a_off)
+			BSA_NODISCARD inline bool operator!() const { return !is_open(); }
+			BSA_NODISCARD explicit inline operator bool() const { return is_open(); }
+
+			inline void get(char& a_ch)
 			{
-				_stream.seekp(a_off, std::ios_base::cur);
-				return *this;
+				a_ch = ref<char>(_pos++);
 			}
 
-		private:
-			stream_type& _stream;
-			pos_type _beg;
-			endian _endian;
-		};
+			template <class OutputIt>
+			inline void read(OutputIt a_dst, size_type a_count)
+			{
+				assert(_pos + a_count <= size());
+				std::copy_n(reinterpret_cast<const char*>(ptr(_pos)), a_count, a_dst);
+				_pos += a_count;
+			}
 
-		class BSA_MAYBE_UNUSED restore_point final
-		{
-		public:
-			using stream_type = istream_t;
+			// hands out the next a_count bytes as a bounds checked block, so that
+			// tables of fixed-size records can be decoded without touching the stream
+			BSA_NODISCARD inline ispan_t read_block(size_type a_count)
+			{
+				if (a_count == 0) {
+					return ispan_t{ {}, _endian };
+				}
+
+				if (_pos + a_count > size()) {
+					throw input_error();
+				}
 
-			restore_point() = delete;
-			restore_point(const restore_point&) = delete;
+				ispan_t block{ subspan(_pos, a_count), _endian };
+				_pos += a_count;
+				return block;
+			}
 
-			inline restore_point(restore_point&& a_rhs) noexcept :
-				_stream(std::move(a_rhs._stream)),
-				_pos(std::move(a_rhs._pos))
+			// like read_block, but at a fixed offset and without moving the cursor
+			BSA_NODISCARD inline ispan_t view_block(size_type a_offset, size_type a_count) const
 			{
-				a_rhs._stream.reset();
-				a_rhs._pos = 0;
+				return ispan_t{ view_at(a_offset, a_count), _endian };
 			}
 
-			BSA_CXX17_CONSTEXPR restore_point(stream_type& a_stream) :
-				_stream(stl::in_place, a_stream),
-				_pos(a_stream.tell())
-			{}
+			// the positional members below never touch the cursor, they only read the
+			// mapping. any number of threads may use them on the same stream at once
 
-			inline ~restore_point()
+			// views a_count bytes at a_offset in place
+			BSA_NODISCARD inline stl::span<value_type> view_at(size_type a_offset, size_type a_count) const
 			{
-				if (_stream) {
-					_stream->get().seek_abs(_pos);
+				if (a_count == 0) {
+					return {};
+				} else if (a_offset > size() || a_count > size() - a_offset) {
+					throw input_error();
 				}
-			}
 
-			restore_point& operator=(const restore_point&) = delete;
+				return subspan(a_offset, a_count);
+			}
 
-			constexpr restore_point& operator=(restore_point&& a_rhs) noexcept
+			// copies a_dst.size() bytes starting at a_offset into a_dst
+			inline void read_at(size_type a_offset, stl::span<stl::byte> a_dst) const
 			{
-				if (this != std::addressof(a_rhs)) {
-					_stream = std::move(a_rhs._stream);
-					a_rhs._stream.reset();
+				const auto src = view_at(a_offset, a_dst.size());
+				std::copy(src.begin(), src.end(), a_dst.begin());
+			}
 
-					_pos = std::move(a_rhs._pos);
-					a_rhs._pos = 0;
+			template <
+				class T,
+				stl::enable_if_t<
+					stl::disjunction_v<
+						std::is_integral<T>,
+						std::is_enum<T>>,
+					int> = 0>
+			BSA_NODISCARD inline T load_at(size_type a_offset) const
+			{
+				return load<T>(view_at(a_offset, sizeof(T)).data(), _endian);
+			}
+
+			// views the whole mapping
+			BSA_NODISCARD inline stl::span<value_type> view() const { return view_at(0, size()); }
+
+			// views a_count bytes in place and steps over them
+			BSA_NODISCARD inline stl::string_view read_view(size_type a_count)
+			{
+				if (a_count == 0) {
+					return {};
+				} else if (_pos + a_count > size()) {
+					throw input_error();
 				}
-				return *this;
+
+				const stl::string_view result{ reinterpret_cast<const char*>(ptr(_pos)), a_count };
+				_pos += a_count;
+				return result;
+			}
+
+			// views the zstring at the cursor, without its terminator, and steps past it
+			BSA_NODISCARD inline stl::string_view read_zstring()
+			{
+				if (_pos >= size()) {
+					throw input_error();
+				}
+
+				const auto first = reinterpret_cast<const char*>(ptr(_pos));
+				const auto last = static_cast<const char*>(std::memchr(first, '\0', size() - _pos));
+				if (!last) {
+					throw input_error();
+				}
+
+				const stl::string_view result{ first, static_cast<size_type>(last - first) };
+				_pos += result.size() + 1;
+				return result;
+			}
+
+			BSA_NODISCARD constexpr size_type tell() const noexcept { return _pos; }
+
+			// seek absolute position
+			inline void seek_abs(size_type a_pos) noexcept
+			{
+				assert(a_pos < size());
+				_pos = a_pos;
+			}
+
+			constexpr void seek_beg() noexcept { _pos = 0; }					 // seek to beginning
+			inline void seek_beg(size_type a_pos) noexcept { seek_abs(a_pos); }	 // seek from beginning
+
+			// seek relative to current position
+			template <
+				class T,
+				stl::enable_if_t<
+					stl::disjunction_v<
+						std::is_integral<T>,
+						std::is_enum<T>>,
+					int> = 0>
+			inline void seek_rel(T a_off) noexcept
+			{
+				assert(_pos + a_off < size());
+				_pos += a_off;
+			}
+
+			BSA_NODISCARD inline bool is_open() const noexcept { return _source != nullptr; }
+
+			inline void open(const boost::filesystem::path& a_path, io_backend a_backend = io_backend::mmap)
+			{
+				switch (a_backend) {
+				case io_backend::mmap:
+					_source = std::make_shared<mapped_source>(a_path);
+					break;
+				case io_backend::pread:
+					_source = std::make_shared<buffered_source>(a_path, false);
+					break;
+				case io_backend::direct:
+					_source = std::make_shared<buffered_source>(a_path, true);
+					break;
+				default:
+					throw input_error();
+				}
+
+				_data = _source->data();
+				_pos = 0;
 			}
 
+			inline void close() noexcept
+			{
+				_source.reset();
+				_data = {};
+				_pos = 0;
+			}
+
+			BSA_NODISCARD inline size_type size() const noexcept { return _data.size(); }
+
+			// the storage the stream reads from, or null if it isn't open
+			BSA_NODISCARD inline observer<const source_t*> source() const noexcept { return _source.get(); }
+
+			// a hint only, which backends without a use for it ignore
+			inline void advise(access_hint a_hint, size_type a_offset = 0, size_type a_count = (std::numeric_limits<size_type>::max)()) const noexcept
+			{
+				if (_source) {
+					_source->advise(a_hint, a_offset, a_count);
+				}
+			}
+
+			inline stl::span<value_type> subspan() const { return subspan(size()); }
+			inline stl::span<value_type> subspan(size_type a_count) const { return subspan(_pos, a_count); }
+
+			inline stl::span<value_type> subspan(size_type a_offset, size_type a_count) const
+			{
+				assert(a_offset + a_count <= size());
+				return { ptr(a_offset), a_count };
+			}
+
+		private:
+			BSA_NODISCARD inline observer<pointer> data() const
+			{
+				assert(is_open());
+				return _data.data();
+			}
+
+			BSA_NODISCARD inline observer<pointer> fetch(size_type a_pos) const
+			{
+				assert(a_pos < size());
+				return data() + a_pos;
+			}
+
+			BSA_NODISCARD inline observer<pointer> ptr(size_type a_pos) const { return fetch(a_pos); }
+			BSA_NODISCARD inline reference ref(size_type a_pos) const { return *fetch(a_pos); }
+
+			template <
+				class T,
+				stl::enable_if_t<
+					stl::disjunction_v<
+						std::is_integral<T>,
+						std::is_enum<T>>,
+					int> = 0>
+			BSA_NODISCARD inline T ref(size_type a_pos) const
+			{
+				return zero_extend<T>(ref(a_pos));
+			}
+
+			std::shared_ptr<const source_t> _source;
+			stl::span<value_type> _data;
+			size_type _pos;
+			endian _endian;
+		};
+
+		// writes into a fixed region of memory, such as part of an output mapping
+		class span_sink final :
+			public osink
+		{
+		public:
+			explicit inline span_sink(stl::span<stl::byte> a_dst) noexcept :
+				_dst(a_dst),
+				_pos(0)
+			{}
+
+			inline void write(stl::span<const stl::byte> a_data) override
+			{
+				if (a_data.size() > _dst.size() - _pos) {
+					throw output_error();
+				}
+
+				std::copy(a_data.begin(), a_data.end(), _dst.data() + _pos);
+				_pos += a_data.size();
+			}
+
+			BSA_NODISCARD constexpr std::size_t tell() const noexcept { return _pos; }
+
 		private:
-			stl::optional<std::reference_wrapper<stream_type>> _stream;
+			stl::span<stl::byte> _dst;
 			std::size_t _pos;
 		};
+
+		// encodes records into a write-combining buffer in front of an osink, so small fields
+		// don't each cost a call into the sink. anything still buffered is handed over by flush()
+		class ostream_t final
+		{
+		public:
+			using sink_type = osink;
+			using char_type = char;
+
+			static constexpr std::size_t buffer_size = 1u << 16;
+
+			inline ostream_t() = delete;
+			inline ostream_t(const ostream_t&) = delete;
+			inline ostream_t(ostream_t&&) = delete;
+
+			// a_bufferSize of 0 passes every write straight through to the sink
+			inline ostream_t(sink_type& a_sink, std::size_t a_bufferSize = buffer_size) :
+				_sink(a_sink),
+				_buffer(),
+				_written(0),
+				_endian(endian::little)
+			{
+				_buffer.reserve(a_bufferSize);
+			}
+
+			~ostream_t() noexcept = default;
+
+			ostream_t& operator=(const ostream_t&) = delete;
+			ostream_t& operator=(ostream_t&&) = delete;
+
+			template <
+				class T,
+				stl::enable_if_t<
+					stl::disjunction_v<
+						std::is_integral<T>,
+						std::is_enum<T>>,
+					int> = 0>
+			inline ostream_t& operator<<(T a_value)
+			{
+				using integer_t =
+					std::conditional_t<
+						(sizeof(T) > sizeof(unsigned int)),
+						stl::make_unsigned_t<T>,
+						unsigned int>;
+				constexpr auto MASK =
+					zero_extend<std::size_t>(
+						(std::numeric_limits<std::uint8_t>::max)());
+
+				const auto value = zero_extend<integer_t>(a_value);
+				std::array<stl::byte, sizeof(T)> buf;
+				auto it = buf.begin();
+
+				switch (_endian) {
+				case endian::little:
+					for (std::size_t i = 0; i < sizeof(T); ++i) {
+						*it++ = zero_extend<stl::byte>((value >> i * byte_v) & MASK);
+					}
+					break;
+				case endian::big:
+					for (auto i = zero_extend<std::ptrdiff_t>(sizeof(T)) - 1; i >= 0; --i) {
+						*it++ = zero_extend<stl::byte>((value >> i * byte_v) & MASK);
+					}
+					break;
+				default:
+					throw output_error();
+				}
+
+				return *this << buf;
+			}
+
+			inline ostream_t& operator<<(char a_value)
+			{
+				return write(std::addressof(a_value), 1);
+			}
+
+			template <std::size_t N>
+			inline ostream_t& operator<<(const std::array<stl::byte, N>& a_value)
+			{
+				return write(reinterpret_cast<const char*>(a_value.data()), a_value.size());
+			}
+
+			template <std::size_t N>
+			inline ostream_t& operator<<(const std::array<char_type, N>& a_value)
+			{
+				return write(a_value.data(), a_value.size());
+			}
+
+			inline ostream_t& operator<<(stl::span<stl::byte> a_value)
+			{
+				return write(reinterpret_cast<const char*>(a_value.data()), a_value.size());
+			}
+
+			inline ostream_t& operator<<(stl::span<const stl::byte> a_value)
+			{
+				return write(reinterpret_cast<const char*>(a_value.data()), a_value.size());
+			}
+
+			inline ostream_t& operator<<(stl::span<char_type> a_value)
+			{
+				return write(a_value.data(), a_value.size());
+			}
+
+			inline ostream_t& operator<<(stl::span<const char_type> a_value)
+			{
+				return write(a_value.data(), a_value.size());
+			}
+
+			inline ostream_t& operator<<(stl::basic_string_view<char_type> a_value)
+			{
+				return write(a_value.data(), a_value.size());
+			}
+
+			constexpr ostream_t& operator<<(endian a_endian) noexcept
+			{
+				_endian = a_endian;
+				return *this;
+			}
+
+			inline ostream_t& write(observer<const char_type*> a_str, std::size_t a_count)
+			{
+				if (a_count == 0) {
+					return *this;
+				} else if (_buffer.size() + a_count > _buffer.capacity()) {
+					flush();
+				}
+
+				const auto first = reinterpret_cast<const stl::byte*>(a_str);
+				if (a_count >= _buffer.capacity()) {
+					_sink.write({ first, a_count });  // too large to be worth copying
+				} else {
+					_buffer.insert(_buffer.end(), first, first + a_count);
+				}
+
+				_written += a_count;
+				return *this;
+			}
+
+			inline void flush()
+			{
+				if (!_buffer.empty()) {
+					_sink.write({ _buffer.data(), _buffer.size() });
+					_buffer.clear();
+				}
+			}
+
+			// the number of bytes written so far, buffered or not
+			BSA_NODISCARD constexpr std::size_t tell() const noexcept { return _written; }
+
+		private:
+			sink_type& _sink;
+			std::vector<stl::byte> _buffer;
+			std::size_t _written;
+			endian _endian;
+		};
+
+		// a hint that a_ptr is about to be read
+		inline void prefetch(observer<const void*> a_ptr) noexcept
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			__builtin_prefetch(a_ptr);
+#elif defined(BSA_HAS_SSE2)
+			_mm_prefetch(static_cast<const char*>(a_ptr), _MM_HINT_T0);
+#else
+			static_cast<void>(a_ptr);
+#endif
+		}
+
+		// an open addressing table from a pair of archive hashes to the position of
+		// the entry they name, built once after the index has been read
+		class hash_index_t final
+		{
+		public:
+			using key_type = std::pair<std::uint64_t, std::uint64_t>;
+			using mapped_type = std::pair<std::size_t, std::size_t>;
+			using size_type = std::size_t;
+
+			hash_index_t() = default;
+			hash_index_t(const hash_index_t&) = default;
+			hash_index_t(hash_index_t&&) noexcept = default;
+
+			~hash_index_t() = default;
+
+			hash_index_t& operator=(const hash_index_t&) = default;
+			hash_index_t& operator=(hash_index_t&&) noexcept = default;
+
+			BSA_NODISCARD inline bool empty() const noexcept { return _size == 0; }
+			BSA_NODISCARD inline size_type size() const noexcept { return _size; }
+
+			inline void clear() noexcept
+			{
+				_slots.clear();
+				_size = 0;
+			}
+
+			// keeps the load factor at or below 1/2
+			inline void reserve(size_type a_count)
+			{
+				size_type capacity = 16;
+				while (capacity < a_count * 2) {
+					capacity <<= 1;
+				}
+
+				if (capacity > _slots.size()) {
+					auto slots = std::move(_slots);
+					_slots.assign(capacity, slot_t{});
+					_size = 0;
+					for (const auto& slot : slots) {
+						if (slot.occupied()) {
+							insert(slot.key, slot.value);
+						}
+					}
+				}
+			}
+
+			// the first insertion of a key wins
+			inline bool insert(const key_type& a_key, const mapped_type& a_value)
+			{
+				if ((_size + 1) * 2 > _slots.size()) {
+					reserve(_size + 1);
+				}
+
+				const auto mask = _slots.size() - 1;
+				for (auto i = mix(a_key) & mask;; i = (i + 1) & mask) {
+					auto& slot = _slots[i];
+					if (!slot.occupied()) {
+						slot.key = a_key;
+						slot.value = a_value;
+						++_size;
+						return true;
+					} else if (slot.key == a_key) {
+						return false;
+					}
+				}
+			}
+
+			// replaces the value of a key that's already present, returns true if it wasn't
+			inline bool insert_or_assign(const key_type& a_key, const mapped_type& a_value)
+			{
+				if ((_size + 1) * 2 > _slots.size()) {
+					reserve(_size + 1);
+				}
+
+				const auto mask = _slots.size() - 1;
+				for (auto i = mix(a_key) & mask;; i = (i + 1) & mask) {
+					auto& slot = _slots[i];
+					if (!slot.occupied()) {
+						slot.key = a_key;
+						slot.value = a_value;
+						++_size;
+						return true;
+					} else if (slot.key == a_key) {
+						slot.value = a_value;
+						return false;
+					}
+				}
+			}
+
+			// the rest of the cluster is shifted back over the hole, so probes never need tombstones
+			inline bool erase(const key_type& a_key) noexcept
+			{
+				if (_slots.empty()) {
+					return false;
+				}
+
+				const auto mask = _slots.size() - 1;
+				auto hole = mix(a_key) & mask;
+				for (;; hole = (hole + 1) & mask) {
+					if (!_slots[hole].occupied()) {
+						return false;
+					} else if (_slots[hole].key == a_key) {
+						break;
+					}
+				}
+
+				for (auto i = (hole + 1) & mask; _slots[i].occupied(); i = (i + 1) & mask) {
+					// a slot can only move back as far as its home
+					const auto home = mix(_slots[i].key) & mask;
+					if (((i - home) & mask) >= ((i - hole) & mask)) {
+						_slots[hole] = _slots[i];
+						hole = i;
+					}
+				}
+
+				_slots[hole] = slot_t{};
+				--_size;
+				return true;
+			}
+
+			BSA_NODISCARD inline const mapped_type* find(const key_type& a_key) const noexcept
+			{
+				return !_slots.empty() ? probe(a_key, mix(a_key) & (_slots.size() - 1)) : nullptr;
+			}
+
+			// a_func(key, value) for every entry, in no particular order
+			template <class F>
+			inline void for_each(F a_func) const
+			{
+				for (const auto& slot : _slots) {
+					if (slot.occupied()) {
+						a_func(slot.key, slot.value);
+					}
+				}
+			}
+
+			// find for every key in a_keys, written to the same slot in a_out. the home slots of a
+			// group of keys are all fetched before any of them are probed, so their misses overlap
+			inline void find_all(stl::span<const key_type> a_keys, stl::span<const mapped_type*> a_out) const noexcept
+			{
+				assert(a_out.size() >= a_keys.size());
+				if (_slots.empty()) {
+					std::fill_n(a_out.data(), a_keys.size(), nullptr);
+					return;
+				}
+
+				constexpr std::size_t group = 16;
+				const auto mask = _slots.size() - 1;
+				std::array<std::size_t, group> homes;
+				for (std::size_t first = 0; first < a_keys.size(); first += group) {
+					const auto count = (std::min)(group, a_keys.size() - first);
+					for (std::size_t i = 0; i < count; ++i) {
+						homes[i] = mix(a_keys[first + i]) & mask;
+						prefetch(std::addressof(_slots[homes[i]]));
+					}
+					for (std::size_t i = 0; i < count; ++i) {
+						a_out[first + i] = probe(a_keys[first + i], homes[i]);
+					}
+				}
+			}
+
+		private:
+			BSA_NODISCARD static constexpr std::size_t npos() noexcept { return (std::numeric_limits<std::size_t>::max)(); }
+
+			struct slot_t final
+			{
+				BSA_NODISCARD constexpr bool occupied() const noexcept { return value.first != npos(); }
+
+				key_type key{ 0, 0 };
+				mapped_type value{ npos(), npos() };
+			};
+
+			BSA_NODISCARD inline const mapped_type* probe(const key_type& a_key, std::size_t a_home) const noexcept
+			{
+				const auto mask = _slots.size() - 1;
+				for (auto i = a_home;; i = (i + 1) & mask) {
+					const auto& slot = _slots[i];
+					if (!slot.occupied()) {
+						return nullptr;
+					} else if (slot.key == a_key) {
+						return std::addressof(slot.value);
+					}
+				}
+			}
+
+			// the archive hashes pack a handful of characters into their low bits,
+			// so they need to be mixed before they can be masked into a bucket
+			BSA_NODISCARD static constexpr std::size_t mix(const key_type& a_key) noexcept
+			{
+				auto x = a_key.first ^ (a_key.second * 0x9E3779B97F4A7C15);
+				x ^= x >> 30;
+				x *= 0xBF58476D1CE4E5B9;
+				x ^= x >> 27;
+				x *= 0x94D049BB133111EB;
+				x ^= x >> 31;
+				return static_cast<std::size_t>(x);
+			}
+
+			std::vector<slot_t> _slots;
+			size_type _size{ 0 };
+		};
+
+		// marks state that's rebuilt on first use after a change, rather than after every change.
+		// threads that find it stale at the same time wait on the one rebuild
+		class stale_guard_t final
+		{
+		public:
+			stale_guard_t() noexcept = default;
+
+			stale_guard_t(const stale_guard_t& a_rhs) noexcept :
+				_stale(a_rhs.stale())
+			{}
+
+			~stale_guard_t() noexcept = default;
+
+			inline stale_guard_t& operator=(const stale_guard_t& a_rhs) noexcept
+			{
+				_stale.store(a_rhs.stale(), std::memory_order_relaxed);
+				return *this;
+			}
+
+			BSA_NODISCARD inline bool stale() const noexcept { return _stale.load(std::memory_order_acquire); }
+
+			inline void invalidate() noexcept { _stale.store(true, std::memory_order_relaxed); }
+			inline void validate() noexcept { _stale.store(false, std::memory_order_release); }
+
+			template <class F>
+			inline void refresh(F&& a_rebuild) const
+			{
+				if (stale()) {
+					const std::lock_guard<std::mutex> l(_lock);
+					if (_stale.load(std::memory_order_relaxed)) {
+						a_rebuild();
+						_stale.store(false, std::memory_order_release);
+					}
+				}
+			}
+
+		private:
+			mutable std::mutex _lock;
+			mutable std::atomic_bool _stale{ false };
+		};
+
+		// a load order of archives merged into one table from a key to the archive that wins it,
+		// where later archives override earlier ones. Traits names the archive_type, and supplies
+		// key_count(archive), for_each_key(archive, func) and contains(archive, key)
+		template <class Traits>
+		class load_order_t final
+		{
+		public:
+			using archive_type = typename Traits::archive_type;
+			using archive_ptr = std::shared_ptr<const archive_type>;
+			using key_type = hash_index_t::key_type;
+			using size_type = std::size_t;
+
+			load_order_t() = default;
+			load_order_t(const load_order_t&) = default;
+			load_order_t(load_order_t&&) noexcept = default;
+
+			~load_order_t() = default;
+
+			load_order_t& operator=(const load_order_t&) = default;
+			load_order_t& operator=(load_order_t&&) noexcept = default;
+
+			BSA_NODISCARD inline const archive_ptr& operator[](size_type a_pos) const noexcept
+			{
+				assert(a_pos < size());
+				return _slots[_order[a_pos]].archive;
+			}
+
+			BSA_NODISCARD inline bool empty() const noexcept { return _order.empty(); }
+			BSA_NODISCARD inline size_type size() const noexcept { return _order.size(); }
+
+			inline void clear() noexcept
+			{
+				_slots.clear();
+				_order.clear();
+				_free.clear();
+				_index.clear();
+			}
+
+			// a_archive overrides every archive before a_pos, and is overridden by every one after.
+			// only the keys of a_archive are looked at
+			inline void insert(size_type a_pos, archive_ptr a_archive)
+			{
+				assert(a_archive != nullptr);
+				if (a_pos > size()) {
+					throw size_error("the position was past the end of the load order");
+				}
+
+				size_type slot;
+				if (!_free.empty()) {
+					slot = _free.back();
+					_free.pop_back();
+				} else {
+					slot = _slots.size();
+					_slots.emplace_back();
+				}
+
+				_slots[slot].archive = std::move(a_archive);
+				_order.insert(_order.begin() + a_pos, slot);
+				update_ranks(a_pos);
+
+				const auto& archive = *_slots[slot].archive;
+				_index.reserve(_index.size() + Traits::key_count(archive));
+				Traits::for_each_key(archive, [&](const key_type& a_key) {
+					const auto owner = _index.find(a_key);
+					if (!owner || _slots[owner->first].rank < a_pos) {
+						_index.insert_or_assign(a_key, { slot, 0 });
+					}
+				});
+			}
+
+			// the keys a_pos won fall through to the next archive down that has them. only the keys
+			// of the erased archive are looked at
+			inline void erase(size_type a_pos)
+			{
+				if (a_pos >= size()) {
+					throw size_error("the position was past the end of the load order");
+				}
+
+				const auto slot = _order[a_pos];
+				const auto archive = std::move(_slots[slot].archive);
+				_slots[slot].rank = npos();
+				_order.erase(_order.begin() + a_pos);
+				update_ranks(a_pos);
+
+				Traits::for_each_key(*archive, [&](const key_type& a_key) {
+					const auto owner = _index.find(a_key);
+					if (owner && owner->first == slot) {
+						auto pos = a_pos;
+						while (pos > 0 && !Traits::contains(*_slots[_order[pos - 1]].archive, a_key)) {
+							--pos;
+						}
+
+						if (pos > 0) {
+							_index.insert_or_assign(a_key, { _order[pos - 1], 0 });
+						} else {
+							_index.erase(a_key);
+						}
+					}
+				});
+
+				_free.push_back(slot);
+			}
+
+			// the archive that wins a_key, or nullptr if no archive has it
+			BSA_NODISCARD inline const archive_type* find(const key_type& a_key) const noexcept
+			{
+				const auto it = _index.find(a_key);
+				return it ? _slots[it->first].archive.get() : nullptr;
+			}
+
+		private:
+			BSA_NODISCARD static constexpr size_type npos() noexcept { return (std::numeric_limits<size_type>::max)(); }
+
+			// archives keep their slot for as long as they're loaded, so inserting or erasing
+			// in the middle of the load order only renumbers ranks, not the table
+			struct slot_t final
+			{
+				archive_ptr archive;
+				size_type rank{ npos() };
+			};
+
+			inline void update_ranks(size_type a_first) noexcept
+			{
+				for (auto i = a_first; i < _order.size(); ++i) {
+					_slots[_order[i]].rank = i;
+				}
+			}
+
+			std::vector<slot_t> _slots;
+			std::vector<size_type> _order;
+			std::vector<size_type> _free;
+			hash_index_t _index;  // key -> { slot, unused }
+		};
+
+		// a load order of archives, where a file in a later archive hides the same file in every
+		// earlier one. paths resolve through one merged table rather than a search per archive,
+		// and adding or removing an archive only revisits the files of that archive. the table
+		// is merged on the keys of Archive's file_index(), which has to be a hash_index_t
+		template <class Archive>
+		class vfs_base_t
+		{
+		public:
+			using archive_ptr = std::shared_ptr<const Archive>;
+
+			// the archive at a_pos in the load order
+			BSA_NODISCARD inline const archive_ptr& operator[](std::size_t a_pos) const noexcept { return _archives[a_pos]; }
+
+			BSA_NODISCARD inline bool empty() const noexcept { return _archives.empty(); }
+			BSA_NODISCARD inline std::size_t size() const noexcept { return _archives.size(); }
+
+			inline void clear() noexcept { _archives.clear(); }
+
+			// a_archive overrides every archive loaded before it
+			inline void push_back(archive_ptr a_archive) { insert(size(), std::move(a_archive)); }
+			inline void push_back(const boost::filesystem::path& a_path) { push_back(std::make_shared<const Archive>(a_path)); }
+
+			// a_archive overrides every archive before a_pos, and is overridden by every one after
+			inline void insert(std::size_t a_pos, archive_ptr a_archive) { _archives.insert(a_pos, std::move(a_archive)); }
+
+			inline void erase(std::size_t a_pos) { _archives.erase(a_pos); }
+
+		protected:
+			using key_type = hash_index_t::key_type;
+
+			vfs_base_t() = default;
+			vfs_base_t(const vfs_base_t&) = default;
+			vfs_base_t(vfs_base_t&&) noexcept = default;
+
+			~vfs_base_t() = default;
+
+			vfs_base_t& operator=(const vfs_base_t&) = default;
+			vfs_base_t& operator=(vfs_base_t&&) noexcept = default;
+
+			// the archive that wins a_key, or nullptr if none of them have it
+			BSA_NODISCARD inline const Archive* find_key(const key_type& a_key) const noexcept { return _archives.find(a_key); }
+
+		private:
+			struct traits final
+			{
+				using archive_type = Archive;
+
+				BSA_NODISCARD static inline std::size_t key_count(const Archive& a_archive) { return a_archive.file_index().size(); }
+
+				template <class F>
+				static inline void for_each_key(const Archive& a_archive, F a_func)
+				{
+					a_archive.file_index().for_each([&](const key_type& a_key, const hash_index_t::mapped_type&) {
+						a_func(a_key);
+					});
+				}
+
+				BSA_NODISCARD static inline bool contains(const Archive& a_archive, const key_type& a_key)
+				{
+					return a_archive.file_index().find(a_key) != nullptr;
+				}
+			};
+
+			load_order_t<traits> _archives;
+		};
+
+		// a sorted set of keys laid out in eytzinger (breadth first) order, next to the position
+		// each key had in sorted order. the keys a search visits first share a few cache lines,
+		// and the ones three levels down share one, so they can be fetched ahead of the search
+		class eytzinger_index_t final
+		{
+		public:
+			using key_type = std::uint64_t;
+			using size_type = std::size_t;
+
+			BSA_NODISCARD static constexpr size_type npos() noexcept { return (std::numeric_limits<size_type>::max)(); }
+
+			eytzinger_index_t() = default;
+			eytzinger_index_t(const eytzinger_index_t&) = default;
+			eytzinger_index_t(eytzinger_index_t&&) noexcept = default;
+
+			~eytzinger_index_t() = default;
+
+			eytzinger_index_t& operator=(const eytzinger_index_t&) = default;
+			eytzinger_index_t& operator=(eytzinger_index_t&&) noexcept = default;
+
+			BSA_NODISCARD inline bool empty() const noexcept { return size() == 0; }
+			BSA_NODISCARD inline size_type size() const noexcept { return !_keys.empty() ? _keys.size() - 1 : 0; }
+
+			inline void clear() noexcept
+			{
+				_keys.clear();
+				_ranks.clear();
+			}
+
+			// a_key(i) is the i'th of a_count keys, which must be in ascending order
+			template <class F>
+			inline void assign(size_type a_count, F a_key)
+			{
+				clear();
+				if (a_count > 0) {
+					// slot 0 is never visited, it only keeps the arithmetic one based
+					_keys.resize(a_count + 1);
+					_ranks.resize(a_count + 1);
+					const auto last = fill(a_key, 0, 1);
+					assert(last == a_count);
+					static_cast<void>(last);
+				}
+			}
+
+			// the sorted position of a_key, or npos if it isn't present
+			BSA_NODISCARD inline size_type find(key_type a_key) const noexcept
+			{
+				const auto count = size();
+				const auto keys = _keys.data();
+				size_type candidate = 0;
+				size_type k = 1;
+				while (k <= count) {
+					if (k * prefetch_stride < count) {
+						prefetch(keys + k * prefetch_stride);
+					}
+
+					const auto less = keys[k] < a_key;
+					candidate = less ? candidate : k;
+					k = 2 * k + static_cast<size_type>(less);
+				}
+
+				return candidate != 0 && keys[candidate] == a_key ? _ranks[candidate] : npos();
+			}
+
+		private:
+			// the descendants of k three levels down start at k * 8
+			static constexpr size_type prefetch_stride = 64 / sizeof(key_type);
+
+			template <class F>
+			inline size_type fill(F& a_key, size_type a_next, size_type a_k)
+			{
+				if (a_k < _keys.size()) {
+					a_next = fill(a_key, a_next, 2 * a_k);
+					_keys[a_k] = a_key(a_next);
+					_ranks[a_k] = a_next++;
+					a_next = fill(a_key, a_next, 2 * a_k + 1);
+				}
+				return a_next;
+			}
+
+			std::vector<key_type> _keys;
+			std::vector<size_type> _ranks;
+		};
+
+		// a monotonic pool of T. objects are constructed in place inside large blocks drawn from
+		// a memory_resource, never move, and are only destroyed along with the pool
+		template <class T>
+		class object_pool final
+		{
+		public:
+			using value_type = T;
+			using size_type = std::size_t;
+
+			explicit inline object_pool(stl::pmr::memory_resource* a_resource) noexcept :
+				_resource(a_resource)
+			{
+				assert(_resource != nullptr);
+			}
+
+			object_pool(const object_pool&) = delete;
+			object_pool(object_pool&&) = delete;
+
+			inline ~object_pool() noexcept
+			{
+				for (auto& block : _blocks) {
+					for (size_type i = 0; i < block.size; ++i) {
+						block.data[i].~T();
+					}
+					_resource->deallocate(block.data, sizeof(T) * block.capacity, alignof(T));
+				}
+			}
+
+			object_pool& operator=(const object_pool&) = delete;
+			object_pool& operator=(object_pool&&) = delete;
+
+			BSA_NODISCARD inline size_type size() const noexcept { return _size; }
+
+			// the next a_count objects will be placed in a single block
+			inline void reserve(size_type a_count)
+			{
+				if (_blocks.empty() || _blocks.back().capacity - _blocks.back().size < a_count) {
+					push_block(a_count);
+				}
+			}
+
+			template <class... Args>
+			BSA_NODISCARD inline T* make(Args&&... a_args)
+			{
+				if (_blocks.empty() || _blocks.back().size == _blocks.back().capacity) {
+					push_block(_blocks.empty() ? 64 : _blocks.back().capacity * 2);
+				}
+
+				auto& block = _blocks.back();
+				const auto result = ::new (static_cast<void*>(block.data + block.size)) T(std::forward<Args>(a_args)...);
+				++block.size;
+				++_size;
+				return result;
+			}
+
+		private:
+			struct block_t final
+			{
+				T* data;
+				size_type size;
+				size_type capacity;
+			};
+
+			inline void push_block(size_type a_capacity)
+			{
+				_blocks.reserve(_blocks.size() + 1);
+				const auto data = _resource->allocate(sizeof(T) * a_capacity, alignof(T));
+				_blocks.push_back(block_t{ static_cast<T*>(data), 0, a_capacity });
+			}
+
+			stl::pmr::memory_resource* _resource;
+			std::vector<block_t> _blocks;
+			size_type _size{ 0 };
+		};
+
+		// owns every index entry of an archive, one object_pool per entry type. the handles it
+		// hands out share ownership of the whole arena instead of each entry, so building an
+		// index costs a handful of block allocations rather than one per entry. handles stay
+		// valid for as long as any of them is alive, even after the archive is gone. entries
+		// must not hold handles into their own arena, or it will never be freed
+		template <class... Ts>
+		class index_arena final
+		{
+		public:
+			explicit inline index_arena(stl::pmr::memory_resource* a_resource) noexcept :
+				_pools((static_cast<void>(sizeof(Ts)), a_resource)...)
+			{}
+
+			index_arena(const index_arena&) = delete;
+			index_arena(index_arena&&) = delete;
+
+			~index_arena() = default;
+
+			index_arena& operator=(const index_arena&) = delete;
+			index_arena& operator=(index_arena&&) = delete;
+
+			// a_resource may be null, in which case the default resource is used
+			BSA_NODISCARD static inline std::shared_ptr<index_arena> create(stl::pmr::memory_resource* a_resource)
+			{
+				return std::make_shared<index_arena>(
+					a_resource ? a_resource : stl::pmr::get_default_resource());
+			}
+
+			template <class T, class... Args>
+			BSA_NODISCARD static inline std::shared_ptr<T> make(const std::shared_ptr<index_arena>& a_arena, Args&&... a_args)
+			{
+				assert(a_arena != nullptr);
+				return std::shared_ptr<T>(a_arena, a_arena->template construct<T>(std::forward<Args>(a_args)...));
+			}
+
+			// the result is owned by the arena
+			template <class T, class... Args>
+			BSA_NODISCARD inline T* construct(Args&&... a_args)
+			{
+				return std::get<object_pool<T>>(_pools).make(std::forward<Args>(a_args)...);
+			}
+
+			template <class T>
+			inline void reserve(std::size_t a_count)
+			{
+				std::get<object_pool<T>>(_pools).reserve(a_count);
+			}
+
+			// entries may hold views into a_input, so its mapping lives as long as the arena
+			inline void source(const istream_t& a_input) { _source = a_input; }
+			BSA_NODISCARD inline const istream_t& source() const noexcept { return _source; }
+
+		private:
+			std::tuple<object_pool<Ts>...> _pools;
+			istream_t _source;
+		};
+
+		// calls a_func(i) for every i in [0, a_count) from up to a_threads threads, where 0 picks
+		// one per core. the first exception thrown is rethrown once every worker has stopped
+		template <class F>
+		inline void parallel_for(std::size_t a_count, std::size_t a_threads, F a_func)
+		{
+			if (a_threads == 0) {
+				a_threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+			}
+			a_threads = (std::min)(a_threads, a_count);
+
+			if (a_threads <= 1) {
+				for (std::size_t i = 0; i < a_count; ++i) {
+					a_func(i);
+				}
+				return;
+			}
+
+			std::atomic_size_t next{ 0 };
+			std::atomic_bool failed{ false };
+			std::exception_ptr error;
+			std::mutex lock;
+
+			const auto work = [&]() noexcept {
+				for (auto i = next++; i < a_count && !failed; i = next++) {
+					try {
+						a_func(i);
+					} catch (...) {
+						const std::lock_guard<std::mutex> l(lock);
+						if (!error) {
+							error = std::current_exception();
+						}
+						failed = true;
+					}
+				}
+			};
+
+			std::vector<std::thread> workers;
+			workers.reserve(a_threads - 1);
+			for (std::size_t i = 1; i < a_threads; ++i) {
+				try {
+					workers.emplace_back(work);
+				} catch (const std::system_error&) {
+					break;	// make do with the threads we have
+				}
+			}
+
+			work();
+			for (auto& worker : workers) {
+				worker.join();
+			}
+
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+
+		// appends a backslash separated archive path to a_root, one component at a time so the
+		// result is valid on platforms where '\\' isn't a separator. archive paths come from
+		// untrusted input, so any component that could step outside a_root is rejected
+		BSA_NODISCARD inline boost::filesystem::path output_path(
+			const boost::filesystem::path& a_root,
+			stl::string_view a_path)
+		{
+			auto result = a_root;
+			while (!a_path.empty()) {
+				const auto pos = a_path.find_first_of("\\/");
+				const auto part = a_path.substr(0, pos);
+				if (!part.empty()) {
+					const boost::filesystem::path component{ std::string(part.data(), part.size()) };
+					if (part == "." || part == ".." ||
+						part.find(':') != stl::string_view::npos ||
+						component.has_root_path()) {
+						throw output_error("archive path escapes the output directory");
+					}
+					result /= component;
+				}
+				a_path = pos != stl::string_view::npos ? a_path.substr(pos + 1) : stl::string_view{};
+			}
+
+			auto root = a_root.begin();
+			auto it = result.begin();
+			for (; root != a_root.end(); ++root, ++it) {
+				if (it == result.end() || *it != *root) {
+					throw output_error("archive path escapes the output directory");
+				}
+			}
+
+			return result;
+		}
+
+		// writes a_data to a_path, replacing any existing file. when a_preallocate is set, the
+		// file's extents are reserved up front so the filesystem can lay them out contiguously
+		inline void write_file(
+			const boost::filesystem::path& a_path,
+			stl::span<const stl::byte> a_data,
+			bool a_preallocate)
+		{
+#ifdef __linux__
+			const auto fd = ::open(a_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+			if (fd == -1) {
+				throw output_error("failed to open output file");
+			}
+
+			if (a_preallocate && !a_data.empty()) {
+				::posix_fallocate(fd, 0, static_cast<::off_t>(a_data.size()));	// only a hint
+			}
+
+			try {
+				fd_sink(fd).write(a_data);
+			} catch (...) {
+				::close(fd);
+				throw;
+			}
+
+			if (::close(fd) == -1) {
+				throw output_error("failed to close output file");
+			}
+#else
+			(void)a_preallocate;
+
+			std::ofstream output;
+			output.rdbuf()->pubsetbuf(nullptr, 0);
+			output.open(a_path.native(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+			if (!output.is_open()) {
+				throw output_error("failed to open output file");
+			}
+
+			output.write(
+				reinterpret_cast<const char*>(a_data.data()),
+				static_cast<std::streamsize>(a_data.size()));
+			if (!output) {
+				throw output_error("failed to write output file");
+			}
+#endif
+		}
+
+#ifdef __linux__
+		// opens the file a_source was read from, so that its data can be read around the source.
+		// returns -1 when a_source has no file, or that file has been replaced since it was read
+		BSA_NODISCARD inline int open_origin(const istream_t& a_source) noexcept
+		{
+			const auto source = a_source.source();
+			if (!source || source->origin().path.empty()) {
+				return -1;
+			}
+
+			const auto& origin = source->origin();
+			const auto fd = ::open(origin.path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd == -1) {
+				return -1;
+			}
+
+			struct ::stat st;
+			if (::fstat(fd, &st) == -1 ||
+				static_cast<std::uint64_t>(st.st_dev) != origin.device ||
+				static_cast<std::uint64_t>(st.st_ino) != origin.inode ||
+				static_cast<std::size_t>(st.st_size) != source->data().size()) {
+				::close(fd);
+				return -1;
+			}
+
+			return fd;
+		}
+#else
+		BSA_NODISCARD inline int open_origin(const istream_t&) noexcept
+		{
+			return -1;
+		}
+#endif
+
+		// writes ranges of an archive's input file to output files without them passing through
+		// userspace, using copy_file_range or else sendfile. anything it can't copy that way, such as
+		// data that isn't part of the input, goes through write_file instead. safe to share
+		class kernel_copier_t final
+		{
+		public:
+			explicit inline kernel_copier_t(const istream_t& a_source) noexcept :
+				_fd(open_origin(a_source))
+			{
+				if (_fd != -1) {
+					_source = a_source.source()->data();
+				}
+			}
+
+			kernel_copier_t(const kernel_copier_t&) = delete;
+			kernel_copier_t(kernel_copier_t&&) = delete;
+
+			inline ~kernel_copier_t() noexcept
+			{
+#ifdef __linux__
+				if (_fd != -1) {
+					::close(_fd);
+				}
+#endif
+			}
+
+			kernel_copier_t& operator=(const kernel_copier_t&) = delete;
+			kernel_copier_t& operator=(kernel_copier_t&&) = delete;
+
+			BSA_NODISCARD inline bool is_open() const noexcept { return _fd != -1; }
+
+			inline void write_file(const boost::filesystem::path& a_path, stl::span<const stl::byte> a_data, bool a_preallocate) const
+			{
+#ifdef __linux__
+				const auto begin = _source.data();
+				const auto end = begin + _source.size();
+				const auto inside =
+					!a_data.empty() &&
+					!std::less<const stl::byte*>()(a_data.data(), begin) &&
+					!std::less<const stl::byte*>()(end, a_data.data() + a_data.size());
+				if (!is_open() || !inside) {
+					detail::write_file(a_path, a_data, a_preallocate);
+					return;
+				}
+
+				const auto fd = ::open(a_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+				if (fd == -1) {
+					throw output_error("failed to open output file");
+				}
+
+				try {
+					if (a_preallocate) {
+						::posix_fallocate(fd, 0, static_cast<::off_t>(a_data.size()));	// only a hint
+					}
+					copy(fd, static_cast<std::size_t>(a_data.data() - begin), a_data.size());
+				} catch (...) {
+					::close(fd);
+					throw;
+				}
+
+				if (::close(fd) == -1) {
+					throw output_error("failed to close output file");
+				}
+#else
+				detail::write_file(a_path, a_data, a_preallocate);
+#endif
+			}
+
+		private:
+			enum method_t : int
+			{
+				kcopy_file_range,
+				ksendfile,
+				kwrite
+			};
+
+#ifdef __linux__
+			inline void copy(int a_out, std::size_t a_offset, std::size_t a_count) const
+			{
+				while (a_count > 0) {
+					::ssize_t copied = -1;
+					switch (_method.load(std::memory_order_relaxed)) {
+					case kcopy_file_range:
+#ifdef __NR_copy_file_range
+						{
+							::loff_t in = static_cast<::loff_t>(a_offset);
+							copied = ::syscall(__NR_copy_file_range, _fd, &in, a_out, nullptr, a_count, 0u);
+							if (copied == -1 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) {
+								_method = ksendfile;  // not between these files, or not on this kernel
+								continue;
+							}
+						}
+#else
+						_method = ksendfile;
+						continue;
+#endif
+						break;
+					case ksendfile:
+						{
+							::off_t in = static_cast<::off_t>(a_offset);
+							copied = ::sendfile(a_out, _fd, &in, a_count);
+							if (copied == -1 && (errno == ENOSYS || errno == EINVAL)) {
+								_method = kwrite;
+								continue;
+							}
+						}
+						break;
+					case kwrite:
+					default:
+						copied = ::write(a_out, _source.data() + a_offset, a_count);
+						break;
+					}
+
+					if (copied == -1) {
+						if (errno == EINTR) {
+							continue;
+						}
+						throw output_error("failed to write output file");
+					} else if (copied == 0) {
+						throw output_error("failed to write output file");
+					}
+
+					a_offset += static_cast<std::size_t>(copied);
+					a_count -= static_cast<std::size_t>(copied);
+				}
+			}
+#endif
+
+			int _fd{ -1 };
+			stl::span<const stl::byte> _source;
+			mutable std::atomic_int _method{ kcopy_file_range };
+		};
+
+		// creates (or truncates) a_path and passes a sink for it to a_writer
+		template <class F>
+		inline void write_file(const boost::filesystem::path& a_path, F&& a_writer)
+		{
+#ifdef __linux__
+			const auto fd = ::open(a_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+			if (fd == -1) {
+				throw output_error("failed to open output file");
+			}
+
+			try {
+				fd_sink sink{ fd };
+				a_writer(static_cast<osink&>(sink));
+			} catch (...) {
+				::close(fd);
+				throw;
+			}
+
+			if (::close(fd) == -1) {
+				throw output_error("failed to close output file");
+			}
+#else
+			std::ofstream output{ a_path.native(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc };
+			if (!output.is_open()) {
+				throw output_error("failed to open output file");
+			}
+
+			ostream_sink sink{ output };
+			a_writer(static_cast<osink&>(sink));
+#endif
+		}
+
+		// creates (or truncates) a_path at exactly a_size bytes, maps it writable and passes
+		// the mapping to a_writer, which must fill all of it
+		template <class F>
+		inline void write_mapped(const boost::filesystem::path& a_path, std::size_t a_size, F&& a_writer)
+		{
+			if (a_size == 0) {	// empty files can't be mapped
+				write_file(a_path, [](osink&) {});
+				return;
+			}
+
+			boost::iostreams::mapped_file_params params{ a_path.string() };
+			params.flags = boost::iostreams::mapped_file_base::readwrite;
+			params.new_file_size = static_cast<boost::iostreams::stream_offset>(a_size);
+
+			boost::iostreams::mapped_file_sink output;
+			try {
+				output.open(params);
+			} catch (...) {
+				throw output_error("failed to map output file");
+			}
+
+			if (!output.is_open() || output.size() != a_size) {
+				throw output_error("failed to map output file");
+			}
+
+			a_writer(stl::span<stl::byte>{ reinterpret_cast<stl::byte*>(output.data()), a_size });
+			output.close();
+		}
+
+#ifdef BSA_HAS_IO_URING
+		// a bare io_uring instance set up through the raw syscalls, so liburing isn't needed.
+		// only what batched extraction uses is wrapped, and it's meant for one thread at a time
+		class uring_t final
+		{
+		public:
+			// the ring is left closed when the kernel lacks io_uring (or IORING_OP_READ/WRITE),
+			// or it's been disabled, e.g. by a seccomp filter
+			explicit inline uring_t(std::size_t a_depth) noexcept
+			{
+				io_uring_params params;
+				std::memset(&params, 0, sizeof(params));
+				const auto fd = ::syscall(__NR_io_uring_setup, static_cast<unsigned>((std::max)(a_depth, std::size_t{ 1 })), &params);
+				if (fd < 0) {
+					return;
+				}
+
+				_fd = static_cast<int>(fd);
+				if ((params.features & IORING_FEAT_RW_CUR_POS) == 0 || !map(params)) {	// IORING_OP_READ/WRITE came with the same kernel
+					close();
+				}
+			}
+
+			uring_t(const uring_t&) = delete;
+			uring_t(uring_t&&) = delete;
+
+			~uring_t() noexcept { close(); }
+
+			uring_t& operator=(const uring_t&) = delete;
+			uring_t& operator=(uring_t&&) = delete;
+
+			BSA_NODISCARD inline bool is_open() const noexcept { return _fd != -1; }
+			BSA_NODISCARD inline std::size_t depth() const noexcept { return _sqEntries; }
+
+			// requests the kernel has been handed but hasn't completed yet
+			BSA_NODISCARD inline std::size_t in_flight() const noexcept { return _inFlight; }
+
+			// queues a read or a write, which reaches the kernel with the next submit_and_wait. the
+			// caller keeps no more than depth() requests outstanding, and a_data untouched until
+			// the request completes
+			inline void read(int a_fd, stl::span<stl::byte> a_data, std::uint64_t a_offset, std::uint64_t a_userData) noexcept
+			{
+				queue(IORING_OP_READ, a_fd, a_data.data(), a_data.size(), a_offset, a_userData);
+			}
+
+			inline void write(int a_fd, stl::span<const stl::byte> a_data, std::uint64_t a_offset, std::uint64_t a_userData) noexcept
+			{
+				queue(IORING_OP_WRITE, a_fd, a_data.data(), a_data.size(), a_offset, a_userData);
+			}
+
+			// hands the queued requests to the kernel, waits for at least one to complete, and then
+			// calls a_func(user_data, result) for every completion there is. returns false if the
+			// kernel refused the submission, which leaves whatever is in flight running
+			template <class F>
+			BSA_NODISCARD inline bool submit_and_wait(F&& a_func) noexcept
+			{
+				if (!enter(_queued)) {
+					return false;
+				}
+				reap(a_func);
+				return true;
+			}
+
+			// drops anything queued but not yet submitted, then waits for every request in flight.
+			// returns false if waiting failed, in which case the kernel may still be using buffers
+			template <class F>
+			BSA_NODISCARD inline bool drain(F&& a_func) noexcept
+			{
+				__atomic_store_n(_sqTail, *_sqTail - _queued, __ATOMIC_RELEASE);
+				_queued = 0;
+
+				reap(a_func);
+				while (_inFlight > 0) {
+					if (!enter(0)) {
+						return false;
+					}
+					reap(a_func);
+				}
+				return true;
+			}
+
+		private:
+			inline void queue(std::uint8_t a_opcode, int a_fd, const void* a_data, std::size_t a_size, std::uint64_t a_offset, std::uint64_t a_userData) noexcept
+			{
+				const auto tail = *_sqTail;	 // only ever written from this side
+				const auto idx = tail & *_sqMask;
+				auto& sqe = _sqes[idx];
+				std::memset(&sqe, 0, sizeof(sqe));
+				sqe.opcode = a_opcode;
+				sqe.fd = a_fd;
+				sqe.addr = reinterpret_cast<std::uint64_t>(a_data);
+				sqe.len = static_cast<std::uint32_t>((std::min)(a_size, std::size_t{ 1u << 30 }));
+				sqe.off = a_offset;
+				sqe.user_data = a_userData;
+				_sqArray[idx] = idx;
+				__atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+				++_queued;
+			}
+
+			// submits a_count of the queued requests and waits for at least one completion
+			BSA_NODISCARD inline bool enter(unsigned a_count) noexcept
+			{
+				for (;;) {
+					const auto submitted = ::syscall(__NR_io_uring_enter, _fd, a_count, 1u, IORING_ENTER_GETEVENTS, nullptr, 0);
+					if (submitted >= 0) {
+						_queued -= static_cast<unsigned>(submitted);
+						_inFlight += static_cast<std::size_t>(submitted);
+						return true;
+					} else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+						return false;
+					}
+				}
+			}
+
+			template <class F>
+			inline void reap(F& a_func) noexcept
+			{
+				auto head = *_cqHead;
+				while (head != __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE)) {
+					const auto& cqe = _cqes[head & *_cqMask];
+					const auto userData = cqe.user_data;
+					const auto result = cqe.res;
+					__atomic_store_n(_cqHead, ++head, __ATOMIC_RELEASE);
+					--_inFlight;
+					a_func(userData, result);
+				}
+			}
+
+			BSA_NODISCARD inline bool map(const io_uring_params& a_params) noexcept
+			{
+				const auto sqSize = a_params.sq_off.array + a_params.sq_entries * sizeof(std::uint32_t);
+				const auto cqSize = a_params.cq_off.cqes + a_params.cq_entries * sizeof(io_uring_cqe);
+				const auto single = (a_params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+				_sqRingSize = single ? (std::max)(sqSize, cqSize) : sqSize;
+				_sqRing = map(_sqRingSize, IORING_OFF_SQ_RING);
+				if (!_sqRing) {
+					return false;
+				}
+
+				if (single) {
+					_cqRing = _sqRing;
+				} else {
+					_cqRingSize = cqSize;
+					_cqRing = map(_cqRingSize, IORING_OFF_CQ_RING);
+					if (!_cqRing) {
+						return false;
+					}
+				}
+
+				_sqesSize = a_params.sq_entries * sizeof(io_uring_sqe);
+				_sqes = static_cast<io_uring_sqe*>(map(_sqesSize, IORING_OFF_SQES));
+				if (!_sqes) {
+					return false;
+				}
+
+				const auto sq = static_cast<char*>(_sqRing);
+				const auto cq = static_cast<char*>(_cqRing);
+				_sqTail = reinterpret_cast<unsigned*>(sq + a_params.sq_off.tail);
+				_sqMask = reinterpret_cast<unsigned*>(sq + a_params.sq_off.ring_mask);
+				_sqArray = reinterpret_cast<unsigned*>(sq + a_params.sq_off.array);
+				_cqHead = reinterpret_cast<unsigned*>(cq + a_params.cq_off.head);
+				_cqTail = reinterpret_cast<unsigned*>(cq + a_params.cq_off.tail);
+				_cqMask = reinterpret_cast<unsigned*>(cq + a_params.cq_off.ring_mask);
+				_cqes = reinterpret_cast<io_uring_cqe*>(cq + a_params.cq_off.cqes);
+				_sqEntries = a_params.sq_entries;
+				return true;
+			}
+
+			BSA_NODISCARD inline void* map(std::size_t a_size, std::uint64_t a_offset) noexcept
+			{
+				const auto result = ::mmap(nullptr, a_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, static_cast<::off_t>(a_offset));
+				return result != MAP_FAILED ? result : nullptr;
+			}
+
+			inline void close() noexcept
+			{
+				if (_sqes) {
+					::munmap(_sqes, _sqesSize);
+				}
+				if (_cqRing && _cqRing != _sqRing) {
+					::munmap(_cqRing, _cqRingSize);
+				}
+				if (_sqRing) {
+					::munmap(_sqRing, _sqRingSize);
+				}
+				if (_fd != -1) {
+					::close(_fd);
+				}
+
+				_sqes = nullptr;
+				_cqRing = nullptr;
+				_sqRing = nullptr;
+				_fd = -1;
+				_sqEntries = 0;
+			}
+
+			int _fd{ -1 };
+			unsigned _queued{ 0 };
+			std::size_t _inFlight{ 0 };
+			std::size_t _sqEntries{ 0 };
+
+			void* _sqRing{ nullptr };
+			std::size_t _sqRingSize{ 0 };
+			unsigned* _sqTail{ nullptr };
+			unsigned* _sqMask{ nullptr };
+			unsigned* _sqArray{ nullptr };
+			io_uring_sqe* _sqes{ nullptr };
+			std::size_t _sqesSize{ 0 };
+
+			void* _cqRing{ nullptr };
+			std::size_t _cqRingSize{ 0 };
+			unsigned* _cqHead{ nullptr };
+			unsigned* _cqTail{ nullptr };
+			unsigned* _cqMask{ nullptr };
+			io_uring_cqe* _cqes{ nullptr };
+		};
+
+		// extracts the files in [a_first, a_last) through a_ring, keeping it full. see extract_files_batched
+		template <class Job, class Decode>
+		inline void extract_files_batched(
+			uring_t& a_ring,
+			int a_source,
+			stl::span<const stl::byte> a_sourceData,
+			std::size_t a_first,
+			std::size_t a_last,
+			bool a_preallocate,
+			Job& a_job,
+			Decode& a_decode)
+		{
+			struct slot_t
+			{
+				std::size_t job{ 0 };
+				boost::filesystem::path path;
+				bool reading{ false };
+				std::size_t offset{ 0 };  // of the stored bytes in the source
+				int fd{ -1 };
+				stl::span<const stl::byte> data;  // what the current request reads into or writes from
+				std::size_t done{ 0 };
+				std::vector<stl::byte> input;
+				std::vector<stl::byte> scratch;
+			};
+
+			std::vector<slot_t> slots(a_ring.depth());
+			std::vector<std::size_t> idle;
+			idle.reserve(slots.size());
+			for (std::size_t i = slots.size(); i > 0; --i) {
+				idle.push_back(i - 1);
+			}
+
+			// the kernel uses the slots' buffers until a request completes, so after an error
+			// whatever is in flight is still waited for before anything is released
+			std::exception_ptr error;
+			const auto fail = [&](std::exception_ptr a_error) noexcept {
+				if (!error) {
+					error = std::move(a_error);
+				}
+			};
+
+			const auto finish = [&](std::size_t a_idx) noexcept {
+				auto& slot = slots[a_idx];
+				if (slot.fd != -1 && ::close(slot.fd) == -1) {
+					fail(std::make_exception_ptr(output_error("failed to close output file")));
+				}
+				slot.fd = -1;
+				idle.push_back(a_idx);
+			};
+
+			const auto issue = [&](std::size_t a_idx) noexcept {
+				auto& slot = slots[a_idx];
+				const stl::span<const stl::byte> rest{ slot.data.data() + slot.done, slot.data.size() - slot.done };
+				if (slot.reading) {
+					a_ring.read(a_source, { slot.input.data() + slot.done, rest.size() }, slot.offset + slot.done, a_idx);
+				} else {
+					a_ring.write(slot.fd, rest, slot.done, a_idx);
+				}
+			};
+
+			// decodes what was read (or the source data itself), then starts writing it out
+			const auto write = [&](std::size_t a_idx, stl::span<const stl::byte> a_stored) noexcept {
+				auto& slot = slots[a_idx];
+				try {
+					slot.data = a_decode(slot.job, a_stored, slot.scratch);
+					slot.fd = ::open(slot.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+					if (slot.fd == -1) {
+						throw output_error("failed to open output file");
+					}
+				} catch (...) {
+					fail(std::current_exception());
+					finish(a_idx);
+					return;
+				}
+
+				slot.reading = false;
+				slot.done = 0;
+				if (slot.data.empty()) {
+					finish(a_idx);
+					return;
+				}
+
+				if (a_preallocate) {
+					::posix_fallocate(slot.fd, 0, static_cast<::off_t>(slot.data.size()));	 // only a hint
+				}
+				issue(a_idx);
+			};
+
+			const auto complete = [&](std::uint64_t a_idx, std::int32_t a_result) noexcept {
+				auto& slot = slots[a_idx];
+				if (a_result > 0) {
+					slot.done += static_cast<std::size_t>(a_result);
+				} else if (a_result == 0 && slot.reading) {
+					fail(std::make_exception_ptr(input_error("input file was truncated while reading")));
+				} else if (a_result != -EINTR && a_result != -EAGAIN) {
+					if (slot.reading) {
+						fail(std::make_exception_ptr(input_error("failed to read input file")));
+					} else {
+						fail(std::make_exception_ptr(output_error("failed to write output file")));
+					}
+				}
+
+				if (error) {
+					finish(a_idx);
+				} else if (slot.done < slot.data.size()) {	// short or interrupted request
+					issue(a_idx);
+				} else if (slot.reading) {
+					write(a_idx, slot.data);
+				} else {
+					finish(a_idx);
+				}
+			};
+
+			const auto sourceBegin = a_sourceData.data();
+			const auto sourceEnd = sourceBegin + a_sourceData.size();
+			auto next = a_first;
+			while (true) {
+				while (!error && next < a_last && !idle.empty()) {
+					const auto idx = idle.back();
+					idle.pop_back();
+					auto& slot = slots[idx];
+					stl::span<const stl::byte> stored;
+					try {
+						slot.job = next++;
+						auto job = a_job(slot.job);
+						slot.path = std::move(job.first);
+						stored = job.second;
+					} catch (...) {
+						fail(std::current_exception());
+						finish(idx);
+						break;
+					}
+
+					// the stored bytes are read through the ring rather than faulted in from the mapping
+					const auto inside =
+						a_source != -1 &&
+						!stored.empty() &&
+						!std::less<const stl::byte*>()(stored.data(), sourceBegin) &&
+						!std::less<const stl::byte*>()(sourceEnd, stored.data() + stored.size());
+					if (inside) {
+						try {
+							slot.input.resize(stored.size());
+						} catch (...) {
+							fail(std::current_exception());
+							finish(idx);
+							break;
+						}
+
+						slot.reading = true;
+						slot.offset = static_cast<std::size_t>(stored.data() - sourceBegin);
+						slot.data = { slot.input.data(), slot.input.size() };
+						slot.done = 0;
+						issue(idx);
+					} else {
+						write(idx, stored);
+					}
+				}
+
+				if (idle.size() == slots.size()) {
+					break;
+				}
+
+				if (!a_ring.submit_and_wait(complete)) {
+					fail(std::make_exception_ptr(output_error("failed to submit to io_uring")));
+					if (!a_ring.drain(complete)) {
+						// there's no telling when the kernel is done with the buffers, so they're never freed
+						for (auto& slot : slots) {
+							if (slot.fd != -1) {
+								::close(slot.fd);
+							}
+						}
+						static_cast<void>(new std::vector<slot_t>(std::move(slots)));
+						std::rethrow_exception(error);
+					}
+
+					// whatever was queued but never submitted was dropped along with the queue
+					for (std::size_t i = 0; i < slots.size(); ++i) {
+						if (std::find(idle.begin(), idle.end(), i) == idle.end()) {
+							finish(i);
+						}
+					}
+					break;
+				}
+			}
+
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+#endif
+
+		// extracts a_count files from a_threads threads (0 picks one per core), each of which keeps
+		// up to a_depth requests in flight on its own io_uring. a_job(i) returns the output path of
+		// the i'th file and its bytes as stored in a_source. when a_source is mapped, those bytes are
+		// read through the ring rather than faulted in. a_decode(i, stored, scratch) then returns
+		// what gets written, which may live in scratch. returns false, having extracted nothing,
+		// when io_uring can't be used
+		template <class Job, class Decode>
+		BSA_NODISCARD inline bool extract_files_batched(
+			const istream_t& a_source,
+			std::size_t a_count,
+			std::size_t a_threads,
+			std::size_t a_depth,
+			bool a_preallocate,
+			Job a_job,
+			Decode a_decode)
+		{
+#ifdef BSA_HAS_IO_URING
+			if (a_threads == 0) {
+				a_threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+			}
+			a_threads = (std::max)((std::min)(a_threads, a_count), std::size_t{ 1 });
+
+			std::vector<std::unique_ptr<uring_t>> rings;
+			rings.reserve(a_threads);
+			for (std::size_t i = 0; i < a_threads; ++i) {
+				rings.push_back(std::make_unique<uring_t>(a_depth));
+				if (!rings.back()->is_open()) {
+					return false;
+				}
+			}
+
+			// in memory sources have nothing left to read
+			const auto source = a_source.source();
+			const auto fd = source && !source->resident() ? open_origin(a_source) : -1;
+			const auto data = fd != -1 ? source->data() : stl::span<const stl::byte>{};
+
+			// contiguous ranges, so each ring reads its part of the source in order
+			try {
+				parallel_for(a_threads, a_threads, [&](std::size_t a_idx) {
+					const auto first = a_count * a_idx / a_threads;
+					const auto last = a_count * (a_idx + 1) / a_threads;
+					extract_files_batched(*rings[a_idx], fd, data, first, last, a_preallocate, a_job, a_decode);
+				});
+			} catch (...) {
+				if (fd != -1) {
+					::close(fd);
+				}
+				throw;
+			}
+
+			if (fd != -1) {
+				::close(fd);
+			}
+			return true;
+#else
+			(void)a_source;
+			(void)a_count;
+			(void)a_threads;
+			(void)a_depth;
+			(void)a_preallocate;
+			(void)a_job;
+			(void)a_decode;
+			return false;
+#endif
+		}
+
+		// an index cache is the file table of an archive laid out flat, so it can be mapped and
+		// searched in place. everything in it is found by its offset from the start of the file,
+		// and is in the byte order of the machine that wrote it, which the header records
+		enum class cache_format : std::uint32_t
+		{
+			tes3 = 1,
+			tes4,
+			fo4
+		};
+
+		struct cache_header_t final
+		{
+			static constexpr std::uint32_t MAGIC = 0x58415342;  // "BSAX"
+			static constexpr std::uint32_t VERSION = 2;
+			static constexpr std::uint32_t ORDER_MARK = 0x01020304;
+
+			std::uint32_t magic;
+			std::uint32_t version;
+			std::uint32_t byteOrder;
+			std::uint32_t format;
+			std::uint64_t archiveSize;
+			std::int64_t archiveTime;		 // last write, in nanoseconds where the platform has them
+			std::int64_t archiveChangeTime;	 // last status change, where the platform has one
+			std::uint64_t archiveInode;
+			std::uint64_t recordCount;
+			std::uint64_t recordOffset;
+			std::uint64_t nameOffset;
+			std::uint64_t nameSize;
+			std::uint64_t pathOffset;  // the archive's absolute path, from nameOffset
+			std::uint64_t pathLength;
+		};
+
+		// sorted by key, which is the same key the archive's own index uses
+		struct cache_record_t final
+		{
+			enum : std::uint16_t
+			{
+				fcompressed = 1u << 0
+			};
+
+			std::uint64_t keyFirst;
+			std::uint64_t keySecond;
+			std::uint64_t offset;  // where the data starts in the archive
+			std::uint32_t size;	   // bytes of data in the archive
+			std::uint32_t uncompressedSize;
+			std::uint32_t nameOffset;  // from nameOffset of the header
+			std::uint16_t nameLength;
+			std::uint16_t flags;
+		};
+
+		static_assert(sizeof(cache_header_t) == 0x60, "the cache header must not be padded");
+		static_assert(sizeof(cache_record_t) == 0x28, "cache records must not be padded");
+
+		class index_cache_t;
+	}
+
+	// a file as an index cache describes it. it points into the mapped cache, so it's only good
+	// for as long as the cache it came from stays open
+	class cached_file final
+	{
+	public:
+		constexpr cached_file() noexcept = default;
+		constexpr cached_file(const cached_file&) noexcept = default;
+		constexpr cached_file(cached_file&&) noexcept = default;
+
+		~cached_file() noexcept = default;
+
+		constexpr cached_file& operator=(const cached_file&) noexcept = default;
+		constexpr cached_file& operator=(cached_file&&) noexcept = default;
+
+		BSA_NODISCARD explicit constexpr operator bool() const noexcept { return exists(); }
+
+		BSA_NODISCARD constexpr bool exists() const noexcept { return _record != nullptr; }
+
+		BSA_NODISCARD inline bool compressed() const noexcept
+		{
+			assert(exists());
+			return (_record->flags & detail::cache_record_t::fcompressed) != 0;
+		}
+
+		// where the data of the file starts in the archive, past any prefixes
+		BSA_NODISCARD inline std::uint64_t offset() const noexcept
+		{
+			assert(exists());
+			return _record->offset;
+		}
+
+		// the number of bytes the data takes up in the archive
+		BSA_NODISCARD inline std::size_t size() const noexcept
+		{
+			assert(exists());
+			return detail::zero_extend<std::size_t>(_record->size);
+		}
+
+		BSA_NODISCARD inline std::size_t uncompressed_size() const noexcept
+		{
+			assert(exists());
+			return detail::zero_extend<std::size_t>(_record->uncompressedSize);
+		}
+
+		BSA_NODISCARD constexpr stl::string_view string() const noexcept { return _name; }
+
+	private:
+		friend class detail::index_cache_t;
+
+		constexpr cached_file(observer<const detail::cache_record_t*> a_record, stl::string_view a_name) noexcept :
+			_record(a_record),
+			_name(a_name)
+		{}
+
+		observer<const detail::cache_record_t*> _record{ nullptr };
+		stl::string_view _name;
+	};
+
+	namespace detail
+	{
+		// a mapped index cache, only kept open while it matches the archive it was written from
+		class index_cache_t final
+		{
+		public:
+			using key_type = hash_index_t::key_type;
+
+			index_cache_t() = default;
+			index_cache_t(const index_cache_t&) = delete;
+			index_cache_t(index_cache_t&&) = delete;
+
+			~index_cache_t() = default;
+
+			index_cache_t& operator=(const index_cache_t&) = delete;
+			index_cache_t& operator=(index_cache_t&&) = delete;
+
+			BSA_NODISCARD inline bool is_open() const noexcept { return _header != nullptr; }
+			BSA_NODISCARD inline std::size_t size() const noexcept { return is_open() ? zero_extend<std::size_t>(_header->recordCount) : 0; }
+
+			inline void close() noexcept
+			{
+				_header = nullptr;
+				_records = nullptr;
+				_names = nullptr;
+				_file.close();
+			}
+
+			// maps a_cache, and keeps it if it was written in a_format from a_archive as that is
+			// on disk now. a missing, damaged or stale cache just leaves this closed
+			inline bool open(
+				const boost::filesystem::path& a_cache,
+				const boost::filesystem::path& a_archive,
+				cache_format a_format)
+			{
+				close();
+
+				stamp_t stamp;
+				if (!stamp.read(a_archive)) {
+					return false;
+				}
+
+				boost::system::error_code ec;
+				const auto size = boost::filesystem::file_size(a_cache, ec);
+				if (ec || size < sizeof(cache_header_t)) {
+					return false;
+				}
+
+				try {
+					_file.open(a_cache);
+				} catch (const std::exception&) {
+					return false;
+				}
+
+				const auto base = _file.data();
+				const auto& header = *reinterpret_cast<const cache_header_t*>(base);
+				const auto fits = [&](std::uint64_t a_offset, std::uint64_t a_count) noexcept {
+					return a_offset <= size && a_count <= size - a_offset;
+				};
+
+				if (header.magic != cache_header_t::MAGIC ||
+					header.version != cache_header_t::VERSION ||
+					header.byteOrder != cache_header_t::ORDER_MARK ||
+					header.format != static_cast<std::uint32_t>(a_format) ||
+					header.archiveSize != stamp.size ||
+					header.archiveTime != stamp.time ||
+					header.archiveChangeTime != stamp.changeTime ||
+					header.archiveInode != stamp.inode ||
+					header.recordOffset % alignof(cache_record_t) != 0 ||
+					header.recordCount > size / sizeof(cache_record_t) ||
+					!fits(header.recordOffset, header.recordCount * sizeof(cache_record_t)) ||
+					!fits(header.nameOffset, header.nameSize) ||
+					!fits(header.pathOffset, header.pathLength) ||
+					header.pathOffset + header.pathLength > header.nameSize ||
+					stl::string_view(base + header.nameOffset + header.pathOffset, zero_extend<std::size_t>(header.pathLength)) != stamp.path) {
+					_file.close();
+					return false;
+				}
+
+				_header = std::addressof(header);
+				_records = reinterpret_cast<const cache_record_t*>(base + header.recordOffset);
+				_names = base + header.nameOffset;
+				return true;
+			}
+
+			BSA_NODISCARD inline cached_file find(const key_type& a_key) const noexcept
+			{
+				const auto first = _records;
+				const auto last = _records + size();
+				const auto it = std::lower_bound(first, last, a_key, [](const cache_record_t& a_lhs, const key_type& a_rhs) noexcept {
+					return key_type{ a_lhs.keyFirst, a_lhs.keySecond } < a_rhs;
+				});
+
+				return it != last && it->keyFirst == a_key.first && it->keySecond == a_key.second ?
+						   cached_file(it, name(*it)) :
+						   cached_file();
+			}
+
+		private:
+			// what a cache is checked against. last_write_time only has whole seconds, which
+			// misses an archive rewritten at the same size within a second of the cache
+			struct stamp_t final
+			{
+				inline bool read(const boost::filesystem::path& a_archive)
+				{
+					const auto absolute = boost::filesystem::absolute(a_archive);
+					path = absolute.generic_string();
+#ifdef __linux__
+					struct ::stat st;
+					if (::stat(absolute.c_str(), &st) == -1) {
+						return false;
+					}
+
+					const auto nanoseconds = [](const ::timespec& a_time) noexcept {
+						return static_cast<std::int64_t>(a_time.tv_sec) * 1000000000 + static_cast<std::int64_t>(a_time.tv_nsec);
+					};
+
+					size = static_cast<std::uint64_t>(st.st_size);
+					time = nanoseconds(st.st_mtim);
+					changeTime = nanoseconds(st.st_ctim);
+					inode = static_cast<std::uint64_t>(st.st_ino);
+					return true;
+#else
+					boost::system::error_code ec;
+					size = boost::filesystem::file_size(absolute, ec);
+					if (!ec) {
+						time = static_cast<std::int64_t>(boost::filesystem::last_write_time(absolute, ec));
+					}
+					return !ec;
+#endif
+				}
+
+				std::uint64_t size{ 0 };
+				std::int64_t time{ 0 };
+				std::int64_t changeTime{ 0 };
+				std::uint64_t inode{ 0 };
+				std::string path;
+			};
+
+			friend class index_cache_writer_t;
+
+			// names past the end of the pool come back empty rather than reading outside the cache
+			BSA_NODISCARD inline stl::string_view name(const cache_record_t& a_record) const noexcept
+			{
+				const auto offset = zero_extend<std::uint64_t>(a_record.nameOffset);
+				const auto length = zero_extend<std::uint64_t>(a_record.nameLength);
+				return offset + length <= _header->nameSize ?
+						   stl::string_view(_names + offset, zero_extend<std::size_t>(length)) :
+						   stl::string_view();
+			}
+
+			boost::iostreams::mapped_file_source _file;
+			observer<const cache_header_t*> _header{ nullptr };
+			observer<const cache_record_t*> _records{ nullptr };
+			observer<const char*> _names{ nullptr };
+		};
+
+		// collects the records of an archive, then writes them out as an index cache
+		class index_cache_writer_t final
+		{
+		public:
+			using key_type = hash_index_t::key_type;
+
+			inline void reserve(std::size_t a_count) { _records.reserve(a_count); }
+
+			// the name is a_parent and a_name joined by a backslash, or just a_name if a_parent is empty
+			inline void add(
+				const key_type& a_key,
+				std::uint64_t a_offset,
+				std::size_t a_size,
+				std::size_t a_uncompressedSize,
+				bool a_compressed,
+				stl::string_view a_parent,
+				stl::string_view a_name)
+			{
+				const auto nameOffset = _names.size();
+				if (!a_parent.empty()) {
+					_names.append(a_parent.data(), a_parent.size());
+					_names += '\\';
+				}
+				_names.append(a_name.data(), a_name.size());
+				const auto nameLength = _names.size() - nameOffset;
+
+				if (a_size > max_uint32 ||
+					a_uncompressedSize > max_uint32 ||
+					nameOffset > max_uint32 ||
+					nameLength > (std::numeric_limits<std::uint16_t>::max)()) {
+					throw size_error();
+				}
+
+				cache_record_t record{};
+				record.keyFirst = a_key.first;
+				record.keySecond = a_key.second;
+				record.offset = a_offset;
+				record.size = static_cast<std::uint32_t>(a_size);
+				record.uncompressedSize = static_cast<std::uint32_t>(a_uncompressedSize);
+				record.nameOffset = static_cast<std::uint32_t>(nameOffset);
+				record.nameLength = static_cast<std::uint16_t>(nameLength);
+				record.flags = a_compressed ? cache_record_t::fcompressed : 0;
+				_records.push_back(record);
+			}
+
+			// the cache is written next to a_cache and renamed over it, so a reader never maps
+			// half of one. the first record added for a key is the one a search finds
+			inline void write(
+				const boost::filesystem::path& a_cache,
+				const boost::filesystem::path& a_archive,
+				cache_format a_format)
+			{
+				index_cache_t::stamp_t stamp;
+				if (!stamp.read(a_archive)) {
+					throw input_error();
+				}
+
+				std::stable_sort(_records.begin(), _records.end(), [](const cache_record_t& a_lhs, const cache_record_t& a_rhs) noexcept {
+					return key_type{ a_lhs.keyFirst, a_lhs.keySecond } < key_type{ a_rhs.keyFirst, a_rhs.keySecond };
+				});
+
+				cache_header_t header{};
+				header.magic = cache_header_t::MAGIC;
+				header.version = cache_header_t::VERSION;
+				header.byteOrder = cache_header_t::ORDER_MARK;
+				header.format = static_cast<std::uint32_t>(a_format);
+				header.archiveSize = stamp.size;
+				header.archiveTime = stamp.time;
+				header.archiveChangeTime = stamp.changeTime;
+				header.archiveInode = stamp.inode;
+				header.recordCount = _records.size();
+				header.recordOffset = sizeof(cache_header_t);
+				header.nameOffset = header.recordOffset + _records.size() * sizeof(cache_record_t);
+				header.pathOffset = _names.size();
+				header.pathLength = stamp.path.size();
+				header.nameSize = _names.size() + stamp.path.size();
+
+				// a name of its own, so writers racing on the same cache don't clobber each other
+				auto temp = a_cache;
+				temp += boost::filesystem::unique_path(".%%%%-%%%%-%%%%-%%%%.tmp");
+				try {
+					write_file(temp, [&](osink& a_sink) {
+						a_sink.write({ reinterpret_cast<const stl::byte*>(std::addressof(header)), sizeof(header) });
+						a_sink.write({ reinterpret_cast<const stl::byte*>(_records.data()), _records.size() * sizeof(cache_record_t) });
+						a_sink.write({ reinterpret_cast<const stl::byte*>(_names.data()), _names.size() });
+						a_sink.write({ reinterpret_cast<const stl::byte*>(stamp.path.data()), stamp.path.size() });
+					});
+				} catch (...) {
+					boost::system::error_code ec;
+					boost::filesystem::remove(temp, ec);
+					throw;
+				}
+
+				boost::system::error_code ec;
+				boost::filesystem::rename(temp, a_cache, ec);
+				if (ec) {
+					boost::filesystem::remove(temp, ec);
+					throw output_error();
+				}
+			}
+
+		private:
+			std::vector<cache_record_t> _records;
+			std::string _names;
+		};
+
+		// the file table of an archive kept as a cache file, which is mapped and searched in place.
+		// opening one costs a few syscalls rather than a parse of the archive. Traits names the
+		// archive_type, and supplies format(), read(path), which parses an archive to be cached,
+		// and add(writer, archive), which adds the records of its files
+		template <class Traits>
+		class index_cache_base_t
+		{
+		public:
+			using archive_type = typename Traits::archive_type;
+
+			index_cache_base_t(const index_cache_base_t&) = delete;
+			index_cache_base_t(index_cache_base_t&&) = delete;
+
+			index_cache_base_t& operator=(const index_cache_base_t&) = delete;
+			index_cache_base_t& operator=(index_cache_base_t&&) = delete;
+
+			BSA_NODISCARD inline bool is_open() const noexcept { return _impl.is_open(); }
+			BSA_NODISCARD inline std::size_t size() const noexcept { return _impl.size(); }
+
+			inline void close() noexcept { _impl.close(); }
+
+			// false, leaving the cache closed, if a_cache is missing, damaged, or wasn't written
+			// from a_archive as it is on disk now
+			inline bool open(const boost::filesystem::path& a_cache, const boost::filesystem::path& a_archive)
+			{
+				return _impl.open(a_cache, a_archive, Traits::format());
+			}
+
+			// opens a_cache, reading a_archive and writing the cache over first if it's out of date
+			inline void open_or_build(const boost::filesystem::path& a_cache, const boost::filesystem::path& a_archive)
+			{
+				if (!open(a_cache, a_archive)) {
+					write(a_cache, a_archive, Traits::read(a_archive));
+					if (!open(a_cache, a_archive)) {
+						throw input_error();
+					}
+				}
+			}
+
+			// a_source has to be a_archive as it was read from disk
+			static inline void write(const boost::filesystem::path& a_cache, const boost::filesystem::path& a_archive, const archive_type& a_source)
+			{
+				index_cache_writer_t writer;
+				Traits::add(writer, a_source);
+				writer.write(a_cache, a_archive, Traits::format());
+			}
+
+		protected:
+			index_cache_base_t() = default;
+			~index_cache_base_t() = default;
+
+			BSA_NODISCARD inline cached_file find_key(const index_cache_t::key_type& a_key) const noexcept { return _impl.find(a_key); }
+
+		private:
+			index_cache_t _impl;
+		};
 	}
 }
@@ -29,6 +29,7 @@ namespace bsa
 			class general_t;
 			class hash_t;
 			class header_t;
+			struct index_cache_traits;
 			class texture_t;
 
 			class header_t
@@ -57,7 +58,7 @@ namespace bsa
 
 				constexpr void clear() noexcept { _block = block_t(); }
 
-				inline void read(istream_t& a_input)
+				inline void read(ispan_t& a_input)
 				{
 					_block.read(a_input);
 					if (magic() != MAGIC) {
@@ -84,7 +85,7 @@ namespace bsa
 					constexpr block_t& operator=(const block_t&) noexcept = default;
 					constexpr block_t& operator=(block_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input)
+					inline void read(ispan_t& a_input)
 					{
 						a_input >>
 							magic >>
@@ -141,7 +142,7 @@ namespace bsa
 				BSA_NODISCARD constexpr stl::string_view extension() const { return stl::string_view(_block.ext.data(), _block.ext.size()); }
 				BSA_NODISCARD constexpr std::uint32_t file_hash() const noexcept { return _block.file; }
 
-				inline void read(istream_t& a_input) { _block.read(a_input); }
+				inline void read(ispan_t& a_input) { _block.read(a_input); }
 
 			protected:
 				friend class file_hasher;
@@ -162,7 +163,7 @@ namespace bsa
 					constexpr block_t& operator=(const block_t&) noexcept = default;
 					constexpr block_t& operator=(block_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input)
+					inline void read(ispan_t& a_input)
 					{
 						a_input >>
 							file >>
@@ -195,43 +196,71 @@ namespace bsa
 				general_t& operator=(const general_t&) = default;
 				general_t& operator=(general_t&&) noexcept = default;
 
-				BSA_NODISCARD inline const char* c_str() const noexcept { return _name.c_str(); }
-
 				BSA_NODISCARD constexpr std::ptrdiff_t chunk_count() const noexcept { return sign_extend<std::ptrdiff_t>(_header.chunkCount); }
 				BSA_NODISCARD constexpr std::size_t chunk_offset() const noexcept { return zero_extend<std::size_t>(_header.chunkOffsetOrType); }
 
 				BSA_NODISCARD constexpr std::ptrdiff_t data_file_index() const noexcept { return sign_extend<std::ptrdiff_t>(_header.dataFileIndex); }
 
+				// the chunks are written back to back, so the file's data is one span of the archive
+				BSA_NODISCARD inline std::size_t data_offset() const noexcept { return !_chunks.empty() ? static_cast<std::size_t>(_chunks.front().dataFileOffset) : 0; }
+
+				BSA_NODISCARD inline bool compressed() const noexcept
+				{
+					return std::any_of(_chunks.begin(), _chunks.end(), [](const chunk_t& a_chunk) { return a_chunk.compressedSize != 0; });
+				}
+
+				BSA_NODISCARD inline std::size_t packed_size() const noexcept
+				{
+					std::size_t result = 0;
+					for (const auto& chunk : _chunks) {
+						result += zero_extend<std::size_t>(chunk.compressedSize != 0 ? chunk.compressedSize : chunk.uncompressedSize);
+					}
+					return result;
+				}
+
+				BSA_NODISCARD inline std::size_t unpacked_size() const noexcept
+				{
+					std::size_t result = 0;
+					for (const auto& chunk : _chunks) {
+						result += zero_extend<std::size_t>(chunk.uncompressedSize);
+					}
+					return result;
+				}
+
 				BSA_NODISCARD constexpr hash_t hash() const noexcept { return _hash; }
 				BSA_NODISCARD constexpr hash_t& hash_ref() noexcept { return _hash; }
 				BSA_NODISCARD constexpr const hash_t& hash_ref() const noexcept { return _hash; }
 
-				BSA_NODISCARD inline std::string str() const { return _name; }
-				BSA_NODISCARD constexpr const std::string& str_ref() const noexcept { return _name; }
+				BSA_NODISCARD inline std::string str() const { return _name.str(); }
+				BSA_NODISCARD inline stl::string_view str_ref() const noexcept { return _name.view(); }
 
 				inline void read(istream_t& a_input)
 				{
-					_hash.read(a_input);
-					_header.read(a_input);
+					auto block = a_input.read_block(hash_t::block_size() + header_t::block_size());
+					_hash.read(block);
+					_header.read(block);
 					if (chunk_count() > 0) {
 						_chunks.resize(zero_extend<std::size_t>(chunk_count()));
+						auto chunks = a_input.read_block(chunk_t::block_size() * _chunks.size());
 						for (auto& chunk : _chunks) {
-							chunk.read(a_input);
+							chunk.read(chunks);
 						}
 					}
 				}
 
+				// bstrings aren't terminated, so the name stays a view without a c_str()
 				inline void read_name(istream_t& a_input)
 				{
 					std::uint16_t length;
 					a_input >> length;
-					_name.resize(length);
-					a_input.read(_name.begin(), _name.length());
+					_name.assign_view(a_input.read_view(length));
 				}
 
 			private:
 				struct header_t	 // BSResource::Archive2::Index::EntryHeader
 				{
+					BSA_NODISCARD static constexpr std::size_t block_size() noexcept { return 0x4; }
+
 					constexpr header_t() noexcept :
 						dataFileIndex(0),
 						chunkCount(0),
@@ -246,7 +275,7 @@ namespace bsa
 					constexpr header_t& operator=(const header_t&) noexcept = default;
 					constexpr header_t& operator=(header_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input)
+					inline void read(ispan_t& a_input)
 					{
 						a_input >>
 							dataFileIndex >>
@@ -261,6 +290,8 @@ namespace bsa
 
 				struct chunk_t	// BSResource::Archive2::Index::Chunk
 				{
+					BSA_NODISCARD static constexpr std::size_t block_size() noexcept { return 0x14; }
+
 					constexpr chunk_t() noexcept :
 						dataFileOffset(0),
 						compressedSize(0),
@@ -275,7 +306,7 @@ namespace bsa
 					constexpr chunk_t& operator=(const chunk_t&) noexcept = default;
 					constexpr chunk_t& operator=(chunk_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input)
+					inline void read(ispan_t& a_input)
 					{
 						a_input >>
 							dataFileOffset >>
@@ -299,7 +330,7 @@ namespace bsa
 				hash_t _hash;
 				header_t _header;
 				std::vector<chunk_t> _chunks;
-				std::string _name;
+				name_t _name;
 			};
 			using general_ptr = std::shared_ptr<general_t>;
 
@@ -318,10 +349,33 @@ namespace bsa
 				BSA_NODISCARD constexpr std::ptrdiff_t chunk_count() const noexcept { return sign_extend<std::ptrdiff_t>(_header.chunkCount); }
 				BSA_NODISCARD constexpr std::size_t chunk_offset() const noexcept { return zero_extend<std::size_t>(_header.chunkOffset); }
 
-				BSA_NODISCARD inline const char* c_str() const noexcept { return _name.c_str(); }
-
 				BSA_NODISCARD constexpr std::ptrdiff_t data_file_index() const noexcept { return sign_extend<std::ptrdiff_t>(_header.dataFileIndex); }
 
+				BSA_NODISCARD inline std::size_t data_offset() const noexcept { return !_chunks.empty() ? static_cast<std::size_t>(_chunks.front().dataFileOffset) : 0; }
+
+				BSA_NODISCARD inline bool compressed() const noexcept
+				{
+					return std::any_of(_chunks.begin(), _chunks.end(), [](const chunk_t& a_chunk) { return a_chunk.size != 0; });
+				}
+
+				BSA_NODISCARD inline std::size_t packed_size() const noexcept
+				{
+					std::size_t result = 0;
+					for (const auto& chunk : _chunks) {
+						result += zero_extend<std::size_t>(chunk.size != 0 ? chunk.size : chunk.uncompressedSize);
+					}
+					return result;
+				}
+
+				BSA_NODISCARD inline std::size_t unpacked_size() const noexcept
+				{
+					std::size_t result = 0;
+					for (const auto& chunk : _chunks) {
+						result += zero_extend<std::size_t>(chunk.uncompressedSize);
+					}
+					return result;
+				}
+
 				BSA_NODISCARD constexpr std::ptrdiff_t flags() const noexcept { return sign_extend<std::ptrdiff_t>(_header.flags); }
 
 				BSA_NODISCARD constexpr std::ptrdiff_t format() const noexcept { return sign_extend<std::ptrdiff_t>(_header.format); }
@@ -334,9 +388,8 @@ namespace bsa
 
 				BSA_NODISCARD constexpr std::ptrdiff_t mip_count() const noexcept { return sign_extend<std::ptrdiff_t>(_header.mipCount); }
 
-				BSA_NODISCARD inline std::string str() const { return _name; }
-				BSA_NODISCARD constexpr std::string& str_ref() noexcept { return _name; }
-				BSA_NODISCARD constexpr const std::string& str_ref() const noexcept { return _name; }
+				BSA_NODISCARD inline std::string str() const { return _name.str(); }
+				BSA_NODISCARD inline stl::string_view str_ref() const noexcept { return _name.view(); }
 
 				BSA_NODISCARD constexpr std::ptrdiff_t tile_mode() const noexcept { return sign_extend<std::ptrdiff_t>(_header.tilemode); }
 
@@ -344,12 +397,14 @@ namespace bsa
 
 				inline void read(istream_t& a_input)
 				{
-					_hash.read(a_input);
-					_header.read(a_input);
+					auto block = a_input.read_block(hash_t::block_size() + header_t::block_size());
+					_hash.read(block);
+					_header.read(block);
 					if (chunk_count() > 0) {
 						_chunks.resize(zero_extend<std::size_t>(chunk_count()));
+						auto chunks = a_input.read_block(chunk_t::block_size() * _chunks.size());
 						for (auto& chunk : _chunks) {
-							chunk.read(a_input);
+							chunk.read(chunks);
 						}
 					}
 				}
@@ -358,13 +413,14 @@ namespace bsa
 				{
 					std::uint16_t length;
 					a_input >> length;
-					_name.resize(length);
-					a_input.read(_name.begin(), _name.length());
+					_name.assign_view(a_input.read_view(length));
 				}
 
 			private:
 				struct header_t	 // BSTextureStreamer::NativeDesc<BSGraphics::TextureHeader>
 				{
+					BSA_NODISCARD static constexpr std::size_t block_size() noexcept { return 0xC; }
+
 					constexpr header_t() noexcept :
 						dataFileIndex(0),
 						chunkCount(0),
@@ -385,7 +441,7 @@ namespace bsa
 					constexpr header_t& operator=(const header_t&) noexcept = default;
 					constexpr header_t& operator=(header_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input)
+					inline void read(ispan_t& a_input)
 					{
 						a_input >>
 							dataFileIndex >>
@@ -412,6 +468,8 @@ namespace bsa
 
 				struct chunk_t	// BSTextureStreamer::ChunkDesc
 				{
+					BSA_NODISCARD static constexpr std::size_t block_size() noexcept { return 0x18; }
+
 					constexpr chunk_t() noexcept :
 						dataFileOffset(0),
 						size(0),
@@ -429,7 +487,7 @@ namespace bsa
 					constexpr chunk_t& operator=(const chunk_t&) noexcept = default;
 					constexpr chunk_t& operator=(chunk_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input)
+					inline void read(ispan_t& a_input)
 					{
 						a_input >>
 							dataFileOffset >>
@@ -457,10 +515,198 @@ namespace bsa
 				hash_t _hash;
 				header_t _header;
 				std::vector<chunk_t> _chunks;
-				std::string _name;
+				name_t _name;
 			};
 			using texture_ptr = std::shared_ptr<texture_t>;
 
+			using index_t = index_arena<general_t, texture_t>;
+
+			// crc-32 over the reflected ieee polynomial, the way the archive uses it: the register
+			// starts at zero and is never inverted
+			BSA_CXX17_INLINE constexpr std::array<std::uint32_t, 256> crc32_table_v = {
+				0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
+				0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91,
+				0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+				0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5,
+				0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B,
+				0x35B5A8FA, 0x42B2986C, 0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+				0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
+				0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924, 0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D,
+				0x76DC4190, 0x01DB7106, 0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+				0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D, 0x91646C97, 0xE6635C01,
+				0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E, 0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457,
+				0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+				0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB,
+				0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0, 0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9,
+				0x5005713C, 0x270241AA, 0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+				0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81, 0xB7BD5C3B, 0xC0BA6CAD,
+				0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A, 0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683,
+				0xE3630B12, 0x94643B84, 0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+				0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB, 0x196C3671, 0x6E6B06E7,
+				0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC, 0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5,
+				0xD6D6A3E8, 0xA1D1937E, 0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+				0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55, 0x316E8EEF, 0x4669BE79,
+				0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236, 0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F,
+				0xC5BA3BBE, 0xB2BD0B28, 0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+				0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F, 0x72076785, 0x05005713,
+				0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38, 0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21,
+				0x86D3D2D4, 0xF1D4E242, 0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+				0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69, 0x616BFFD3, 0x166CCF45,
+				0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2, 0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB,
+				0xAED16A4A, 0xD9D65ADC, 0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+				0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693, 0x54DE5729, 0x23D967BF,
+				0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+			};
+
+			BSA_NODISCARD constexpr std::uint32_t crc32_step(std::uint32_t a_crc, char a_ch) noexcept
+			{
+				return (a_crc >> 8) ^ crc32_table_v[(a_crc ^ zero_extend<std::uint8_t>(a_ch)) & 0xFF];
+			}
+
+			// table[n][i] is the crc of byte i followed by n zeros, so 8 bytes can be looked up at once
+			struct crc32_slices_t
+			{
+				std::uint32_t table[8][256];
+			};
+
+			BSA_NODISCARD constexpr crc32_slices_t make_crc32_slices() noexcept
+			{
+				crc32_slices_t slices{};
+				for (std::size_t i = 0; i < 256; ++i) {
+					slices.table[0][i] = crc32_table_v[i];
+				}
+				for (std::size_t n = 1; n < 8; ++n) {
+					for (std::size_t i = 0; i < 256; ++i) {
+						const auto prev = slices.table[n - 1][i];
+						slices.table[n][i] = (prev >> 8) ^ crc32_table_v[prev & 0xFF];
+					}
+				}
+				return slices;
+			}
+
+			BSA_CXX17_INLINE constexpr crc32_slices_t crc32_slices_v = make_crc32_slices();
+
+			inline std::uint32_t crc32_sliced(std::uint32_t a_crc, const unsigned char* a_data, std::size_t a_size) noexcept
+			{
+				const auto& t = crc32_slices_v.table;
+				const auto load = [](const unsigned char* a_src) noexcept {
+					std::uint32_t val = 0;
+					std::memcpy(&val, a_src, sizeof(val));
+					return boost::endian::little_to_native(val);
+				};
+
+				for (; a_size >= 8; a_data += 8, a_size -= 8) {
+					const auto lo = load(a_data) ^ a_crc;
+					const auto hi = load(a_data + 4);
+					a_crc =
+						t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+						t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+				}
+				for (; a_size > 0; ++a_data, --a_size) {
+					a_crc = (a_crc >> 8) ^ t[0][(a_crc ^ *a_data) & 0xFF];
+				}
+				return a_crc;
+			}
+
+#ifdef BSA_HAS_PCLMUL
+			// multiplies both halves of a_acc by a_keys, which moves them a_keys' distance ahead,
+			// and adds them to a_next
+			BSA_TARGET_PCLMUL inline __m128i crc32_fold(__m128i a_acc, __m128i a_next, __m128i a_keys) noexcept
+			{
+				return _mm_xor_si128(
+					_mm_xor_si128(_mm_clmulepi64_si128(a_acc, a_keys, 0x00), _mm_clmulepi64_si128(a_acc, a_keys, 0x11)),
+					a_next);
+			}
+
+			// folds 64 bytes per round with carry-less multiplies, then barrett reduces the
+			// remainder, see intel's "fast crc computation for generic polynomials using
+			// pclmulqdq". a_size must be a multiple of 16, and at least 64
+			BSA_TARGET_PCLMUL inline std::uint32_t crc32_folded(std::uint32_t a_crc, const unsigned char* a_data, std::size_t a_size) noexcept
+			{
+				assert(a_size >= 64 && a_size % 16 == 0);
+				const auto load = [](const unsigned char* a_src) noexcept {
+					return _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_src));
+				};
+
+				auto x0 = _mm_xor_si128(load(a_data), _mm_cvtsi32_si128(static_cast<int>(a_crc)));
+				auto x1 = load(a_data + 16);
+				auto x2 = load(a_data + 32);
+				auto x3 = load(a_data + 48);
+				a_data += 64;
+				a_size -= 64;
+
+				// the keys are x^(n+32) and x^(n-32) mod p, bit reflected, for folds of n bits
+				const auto k512 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+				for (; a_size >= 64; a_data += 64, a_size -= 64) {
+					x0 = crc32_fold(x0, load(a_data), k512);
+					x1 = crc32_fold(x1, load(a_data + 16), k512);
+					x2 = crc32_fold(x2, load(a_data + 32), k512);
+					x3 = crc32_fold(x3, load(a_data + 48), k512);
+				}
+
+				const auto k128 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+				x0 = crc32_fold(x0, x1, k128);
+				x0 = crc32_fold(x0, x2, k128);
+				x0 = crc32_fold(x0, x3, k128);
+				for (; a_size >= 16; a_data += 16, a_size -= 16) {
+					x0 = crc32_fold(x0, load(a_data), k128);
+				}
+
+				// 128 bits down to 64
+				const auto low32 = _mm_setr_epi32(~0, 0, ~0, 0);
+				x0 = _mm_xor_si128(_mm_clmulepi64_si128(x0, k128, 0x10), _mm_srli_si128(x0, 8));
+				x0 = _mm_xor_si128(
+					_mm_clmulepi64_si128(_mm_and_si128(x0, low32), _mm_set_epi64x(0, 0x0163CD6124), 0x00),
+					_mm_srli_si128(x0, 4));
+
+				// and down to 32
+				const auto poly = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+				auto x = _mm_clmulepi64_si128(_mm_and_si128(x0, low32), poly, 0x10);
+				x = _mm_clmulepi64_si128(_mm_and_si128(x, low32), poly, 0x00);
+				return static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(_mm_xor_si128(x0, x), 4)));
+			}
+
+			BSA_NODISCARD inline bool has_pclmul() noexcept
+			{
+				static const bool supported = []() noexcept {
+#ifdef _MSC_VER
+					int info[4] = {};
+					__cpuid(info, 1);
+					return (info[2] & (1 << 1)) != 0;
+#else
+					return __builtin_cpu_supports("pclmul") != 0;
+#endif
+				}();
+				return supported;
+			}
+#endif
+
+			// crc32 one char at a time, for constant evaluation
+			BSA_NODISCARD constexpr std::uint32_t crc32_bytewise(std::uint32_t a_crc, stl::string_view a_data) noexcept
+			{
+				for (const auto& ch : a_data) {
+					a_crc = crc32_step(a_crc, ch);
+				}
+				return a_crc;
+			}
+
+			// continues a_crc over a_data. folding needs 64 bytes to get going, which most paths
+			// never reach, so those stay on the tables
+			BSA_NODISCARD inline std::uint32_t crc32(std::uint32_t a_crc, stl::string_view a_data) noexcept
+			{
+				auto data = reinterpret_cast<const unsigned char*>(a_data.data());
+				auto size = a_data.size();
+#ifdef BSA_HAS_PCLMUL
+				if (size >= 64 && has_pclmul()) {
+					const auto folded = size & ~std::size_t{ 15 };
+					a_crc = crc32_folded(a_crc, data, folded);
+					data += folded;
+					size -= folded;
+				}
+#endif
+				return crc32_sliced(a_crc, data, size);
+			}
+
 			class file_hasher
 			{
 			public:
@@ -475,115 +721,47 @@ namespace bsa
 
 				BSA_NODISCARD inline hash_t operator()(stl::string_view a_path) const
 				{
-					for (auto& ch : a_path) {
-						if (ch < 0) {
-							throw hash_non_ascii();
-						}
-					}
-
-					std::string file;
-					std::string extension;
-					std::string directory;
-					std::tie(file, extension, directory) = normalize(std::move(a_path));
-
-					hash_t hash;
-					auto& block = hash.block_ref();
-
-					block.file = hash_string(file);
-					block.dir = hash_string(directory);
-					for (std::size_t i = 0; i < (std::min)(extension.size(), block.ext.size()); ++i) {
-						block.ext[i] = extension[i];
-					}
+					verify(a_path);
+					path_buffer_t buffer{ a_path.size() };
+					const auto parts = normalize_path(a_path, buffer);
+					return hash(parts, hash_string(parts.stem), hash_string(parts.parent));
+				}
 
-					return hash;
+				BSA_NODISCARD constexpr hash_t operator()(const static_path_t& a_path) const
+				{
+					const auto& parts = a_path.parts();
+					return hash(parts, crc32_bytewise(0, parts.stem), crc32_bytewise(0, parts.parent));
 				}
 
 			private:
-				static constexpr std::array<std::uint32_t, 256> CRCTABLE = {
-					0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
-					0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91,
-					0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
-					0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5,
-					0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B,
-					0x35B5A8FA, 0x42B2986C, 0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
-					0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
-					0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924, 0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D,
-					0x76DC4190, 0x01DB7106, 0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
-					0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D, 0x91646C97, 0xE6635C01,
-					0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E, 0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457,
-					0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
-					0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB,
-					0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0, 0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9,
-					0x5005713C, 0x270241AA, 0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
-					0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81, 0xB7BD5C3B, 0xC0BA6CAD,
-					0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A, 0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683,
-					0xE3630B12, 0x94643B84, 0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
-					0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB, 0x196C3671, 0x6E6B06E7,
-					0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC, 0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5,
-					0xD6D6A3E8, 0xA1D1937E, 0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
-					0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55, 0x316E8EEF, 0x4669BE79,
-					0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236, 0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F,
-					0xC5BA3BBE, 0xB2BD0B28, 0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
-					0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F, 0x72076785, 0x05005713,
-					0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38, 0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21,
-					0x86D3D2D4, 0xF1D4E242, 0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
-					0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69, 0x616BFFD3, 0x166CCF45,
-					0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2, 0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB,
-					0xAED16A4A, 0xD9D65ADC, 0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
-					0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693, 0x54DE5729, 0x23D967BF,
-					0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
-				};
-
-				BSA_NODISCARD constexpr std::uint32_t hash_string(stl::string_view a_string) const
+				BSA_NODISCARD inline std::uint32_t hash_string(stl::string_view a_string) const noexcept
 				{
-					std::uint32_t hash = 0;
-					for (auto& ch : a_string) {
-						hash = (hash >> 8) ^ CRCTABLE[(hash ^ zero_extend<std::uint8_t>(ch)) & 0xFF];
-					}
-					return hash;
+					return crc32(0, a_string);
 				}
 
-				BSA_NODISCARD inline std::tuple<std::string, std::string, std::string> normalize(stl::string_view a_path) const
+				BSA_NODISCARD constexpr hash_t hash(const path_parts_t& a_parts, std::uint32_t a_file, std::uint32_t a_dir) const
 				{
-					boost::filesystem::path path{ a_path.begin(), a_path.end() };
-					path = path.lexically_normal();
-
-					std::string file;
-					if (path.has_stem()) {
-						file = path.stem().string();
-						tidy_string(file);
+					auto extension = a_parts.extension;
+					if (!extension.empty()) {
+						extension.remove_prefix(1);	 // the dot
 					}
 
-					std::string extension;
-					if (path.has_extension()) {
-						extension = path.extension().string();
-						for (auto& ch : extension) {
-							ch = mapchar(ch);
-						}
-						if (!extension.empty() && extension.front() == '.') {
-							extension = extension.substr(1);
-						}
-					}
+					hash_t hash;
+					auto& block = hash.block_ref();
 
-					std::string directory;
-					if (path.has_parent_path()) {
-						directory = path.parent_path().string();
-						tidy_string(directory);
+					block.file = a_file;
+					block.dir = a_dir;
+					for (std::size_t i = 0; i < (std::min)(extension.size(), block.ext.size()); ++i) {
+						block.ext[i] = extension[i];
 					}
 
-					return std::make_tuple(std::move(file), std::move(extension), std::move(directory));
+					return hash;
 				}
 
-				inline void tidy_string(std::string& a_str) const
+				inline void verify(stl::string_view a_path) const
 				{
-					for (auto& ch : a_str) {
-						ch = mapchar(ch);
-					}
-					while (!a_str.empty() && a_str.back() == '\\') {
-						a_str.pop_back();
-					}
-					while (!a_str.empty() && a_str.front() == '\\') {
-						a_str = a_str.substr(1);
+					if (!is_ascii(a_path)) {
+						throw hash_non_ascii();
 					}
 				}
 			};
@@ -595,6 +773,18 @@ namespace bsa
 		class general_file;
 		class hash;
 		class texture_file;
+		class index_cache;
+		class vfs;
+
+		namespace literals
+		{
+			// the hash of a path worked out at compile time, i.e. "meshes/bucket01.nif"_file. the
+			// archive hands out hashes as views of its own, so this is the value they refer to
+			BSA_NODISCARD BSA_CXX20_CONSTEVAL detail::hash_t operator""_file(const char* a_path, std::size_t a_length)
+			{
+				return detail::file_hasher()(detail::static_path_t{ { a_path, a_length } });
+			}
+		}
 
 		class hash
 		{
@@ -641,11 +831,11 @@ namespace bsa
 			general_file& operator=(general_file&&) noexcept = default;
 
 			BSA_NODISCARD inline std::ptrdiff_t chunk_count() const noexcept { return _impl->chunk_count(); }
-			BSA_NODISCARD inline const char* c_str() const noexcept { return _impl->c_str(); }
 			BSA_NODISCARD inline hash hash_value() const noexcept { return hash{ _impl->hash_ref() }; }
-			BSA_NODISCARD inline const std::string& string() const noexcept { return _impl->str_ref(); }
+			BSA_NODISCARD inline stl::string_view string() const noexcept { return _impl->str_ref(); }
 
 		protected:
+			friend class archive;
 			friend class file_iterator;
 
 			using value_type = detail::general_ptr;
@@ -672,17 +862,17 @@ namespace bsa
 			inline texture_file& operator=(texture_file&&) noexcept = default;
 
 			BSA_NODISCARD inline std::ptrdiff_t chunk_count() const noexcept { return _impl->chunk_count(); }
-			BSA_NODISCARD inline const char* c_str() const noexcept { return _impl->c_str(); }
 			BSA_NODISCARD inline std::ptrdiff_t flags() const noexcept { return _impl->flags(); }
 			BSA_NODISCARD inline std::ptrdiff_t format() const noexcept { return _impl->format(); }
 			BSA_NODISCARD inline hash hash_value() const noexcept { return hash{ _impl->hash_ref() }; }
 			BSA_NODISCARD inline std::size_t height() const noexcept { return _impl->height(); }
 			BSA_NODISCARD inline std::ptrdiff_t mip_count() const noexcept { return _impl->mip_count(); }
-			BSA_NODISCARD inline const std::string& string() const noexcept { return _impl->str_ref(); }
+			BSA_NODISCARD inline stl::string_view string() const noexcept { return _impl->str_ref(); }
 			BSA_NODISCARD inline std::ptrdiff_t tile_mode() const noexcept { return _impl->tile_mode(); }
 			BSA_NODISCARD inline std::size_t width() const noexcept { return _impl->width(); }
 
 		protected:
+			friend class archive;
 			friend class file_iterator;
 
 			using value_type = detail::texture_ptr;
@@ -727,35 +917,24 @@ namespace bsa
 			file_entry& operator=(const file_entry&) = default;
 			file_entry& operator=(file_entry&&) noexcept = default;
 
+			BSA_NODISCARD explicit constexpr operator bool() const noexcept { return exists(); }
+			BSA_NODISCARD constexpr bool exists() const noexcept { return _impl.index() != imono; }
+
 			BSA_NODISCARD constexpr bool is_general_file() const noexcept { return _impl.index() == igeneral; }
 			BSA_NODISCARD constexpr bool is_texture_file() const noexcept { return _impl.index() == itexture; }
 
 			BSA_NODISCARD constexpr const general_file& general_file() const { return stl::get<igeneral>(_impl); }
 			BSA_NODISCARD constexpr const texture_file& texture_file() const { return stl::get<itexture>(_impl); }
 
-			BSA_NODISCARD const char* c_str() const noexcept
-			{
-				switch (_impl.index()) {
-				case igeneral:
-					return stl::get<igeneral>(_impl).c_str();
-				case itexture:
-					return stl::get<itexture>(_impl).c_str();
-				default:
-					return "";
-				}
-			}
-
-			BSA_NODISCARD const std::string& string() const noexcept
+			BSA_NODISCARD stl::string_view string() const noexcept
 			{
-				static std::string defaultStr;
-
 				switch (_impl.index()) {
 				case igeneral:
 					return stl::get<igeneral>(_impl).string();
 				case itexture:
 					return stl::get<itexture>(_impl).string();
 				default:
-					return defaultStr;
+					return {};
 				}
 			}
 
@@ -879,6 +1058,8 @@ namespace bsa
 			std::size_t _pos;
 		};
 
+		// once read, the archive may be iterated from several threads at once. read and
+		// clear need exclusive access
 		class archive
 		{
 		public:
@@ -889,9 +1070,17 @@ namespace bsa
 			archive(const archive&) = default;
 			archive(archive&&) noexcept = default;
 
-			inline archive(const boost::filesystem::path& a_path) :
+			// index entries are allocated from a_resource, which must outlive every file handle
+			// taken from the archive
+			explicit inline archive(stl::pmr::memory_resource* a_resource) noexcept :
+				_resource(a_resource)
+			{}
+
+			inline archive(const boost::filesystem::path& a_path, stl::pmr::memory_resource* a_resource = nullptr) :
 				_files(),
-				_header()
+				_header(),
+				_index(),
+				_resource(a_resource)
 			{
 				read(a_path);
 			}
@@ -936,15 +1125,19 @@ namespace bsa
 				} catch (...) {}
 
 				_header.clear();
+				_index.reset();
+				_fileIndex.clear();
 			}
 
-			inline void read(const boost::filesystem::path& a_path)
+			inline void read(const boost::filesystem::path& a_path, io_backend a_backend = io_backend::mmap)
 			{
-				detail::istream_t input{ a_path };
+				detail::istream_t input{ a_path, a_backend };
+				input.advise(detail::access_hint::sequential);
 
 				clear();
 
-				_header.read(input);
+				auto header = input.read_block(detail::header_t::block_size());
+				_header.read(header);
 				switch (_header.version()) {
 				case v1:
 					break;
@@ -952,16 +1145,20 @@ namespace bsa
 					throw version_error();
 				}
 
+				_index = detail::index_t::create(_resource);
+				_index->source(input);
 				if (_header.general()) {
+					_index->reserve<detail::general_t>(_header.file_count());
 					_files.emplace<cgeneral>(_header.file_count());
 					for (auto& file : stl::get<cgeneral>(_files)) {
-						file = std::make_shared<detail::general_t>();
+						file = detail::index_t::make<detail::general_t>(_index);
 						file->read(input);
 					}
 				} else if (_header.directx()) {
+					_index->reserve<detail::texture_t>(_header.file_count());
 					_files.emplace<ctexture>(_header.file_count());
 					for (auto& file : stl::get<ctexture>(_files)) {
-						file = std::make_shared<detail::texture_t>();
+						file = detail::index_t::make<detail::texture_t>(_index);
 						file->read(input);
 					}
 				} else {
@@ -987,10 +1184,52 @@ namespace bsa
 					}
 				}
 
+				build_index();
 				assert(sanity_check());
 			}
 
+			// a_path is the full path of the file, i.e. "meshes/clutter/bucket01.nif"
+			BSA_NODISCARD inline file_entry find(stl::string_view a_path) const { return find(detail::file_hasher()(a_path)); }
+
+			BSA_NODISCARD inline file_entry find(const detail::hash_t& a_hash) const noexcept
+			{
+				const auto it = _fileIndex.find(make_key(a_hash));
+				return it ? file_at(it->first) : file_entry();
+			}
+
+			// find for every hash in a_hashes, written to the same slot in a_out. the index is
+			// probed a group at a time, so the cache misses of a long list overlap
+			inline void find_all(stl::span<const detail::hash_t> a_hashes, stl::span<file_entry> a_out) const
+			{
+				if (a_out.size() < a_hashes.size()) {
+					throw size_error("not enough room for the results");
+				}
+
+				constexpr std::size_t chunk = 256;
+				std::array<detail::hash_index_t::key_type, chunk> keys;
+				std::array<const detail::hash_index_t::mapped_type*, chunk> found;
+				for (std::size_t first = 0; first < a_hashes.size(); first += chunk) {
+					const auto count = (std::min)(chunk, a_hashes.size() - first);
+					for (std::size_t i = 0; i < count; ++i) {
+						keys[i] = make_key(a_hashes[first + i]);
+					}
+
+					_fileIndex.find_all({ keys.data(), count }, { found.data(), count });
+					for (std::size_t i = 0; i < count; ++i) {
+						a_out[first + i] = found[i] ? file_at(found[i]->first) : file_entry();
+					}
+				}
+			}
+
+			BSA_NODISCARD inline bool contains(stl::string_view a_path) const { return static_cast<bool>(find(a_path)); }
+			BSA_NODISCARD inline bool contains(const detail::hash_t& a_hash) const noexcept { return static_cast<bool>(find(a_hash)); }
+
 		private:
+			friend class index_cache;
+			friend class vfs;
+			friend class detail::vfs_base_t<archive>;
+			friend struct detail::index_cache_traits;
+
 			using cgeneral = std::vector<detail::general_ptr>;
 			using ctexture = std::vector<detail::texture_ptr>;
 
@@ -1000,6 +1239,45 @@ namespace bsa
 				itexture
 			};
 
+			BSA_NODISCARD static constexpr detail::hash_index_t::key_type make_key(const detail::hash_t& a_hash) noexcept
+			{
+				const auto ext = a_hash.extension();
+				std::uint64_t packed = 0;
+				for (std::size_t i = 0; i < ext.size(); ++i) {
+					packed |= detail::zero_extend<std::uint64_t>(ext[i]) << i * 8;
+				}
+				return {
+					detail::zero_extend<std::uint64_t>(a_hash.directory_hash()) << 32 | a_hash.file_hash(),
+					packed
+				};
+			}
+
+			BSA_NODISCARD inline const detail::hash_index_t& file_index() const noexcept { return _fileIndex; }
+
+			inline void build_index()
+			{
+				stl::visit(
+					[&](auto&& a_files) {
+						_fileIndex.reserve(a_files.size());
+						for (std::size_t i = 0; i < a_files.size(); ++i) {
+							_fileIndex.insert(make_key(a_files[i]->hash_ref()), { i, 0 });
+						}
+					},
+					_files);
+			}
+
+			BSA_NODISCARD inline file_entry file_at(std::size_t a_idx) const
+			{
+				switch (_files.index()) {
+				case igeneral:
+					return file_entry(general_file(stl::get<igeneral>(_files)[a_idx]));
+				case itexture:
+					return file_entry(texture_file(stl::get<itexture>(_files)[a_idx]));
+				default:
+					return file_entry();
+				}
+			}
+
 			inline bool sanity_check()
 			{
 				switch (_files.index()) {
@@ -1029,6 +1307,77 @@ namespace bsa
 
 			stl::variant<cgeneral, ctexture> _files;
 			detail::header_t _header;
+			std::shared_ptr<detail::index_t> _index;
+			detail::hash_index_t _fileIndex;
+			stl::pmr::memory_resource* _resource{ nullptr };
+		};
+
+		namespace detail
+		{
+			// how index_cache reads and records fo4 archives. textures are recorded as the span
+			// of their chunks, without the dds header
+			struct index_cache_traits final
+			{
+				using archive_type = archive;
+
+				BSA_NODISCARD static constexpr cache_format format() noexcept { return cache_format::fo4; }
+
+				BSA_NODISCARD static inline archive read(const boost::filesystem::path& a_path) { return archive{ a_path }; }
+
+				static inline void add(index_cache_writer_t& a_writer, const archive& a_source)
+				{
+					a_writer.reserve(a_source.file_count());
+					stl::visit(
+						[&](auto&& a_files) {
+							for (const auto& file : a_files) {
+								a_writer.add(
+									archive::make_key(file->hash_ref()),
+									file->data_offset(),
+									file->packed_size(),
+									file->unpacked_size(),
+									file->compressed(),
+									{},
+									file->str_ref());
+							}
+						},
+						a_source._files);
+				}
+			};
+		}
+
+		// files are keyed by the same hash the archive uses. see detail::index_cache_base_t
+		class index_cache final :
+			public detail::index_cache_base_t<detail::index_cache_traits>
+		{
+		public:
+			// a_path as for archive::find
+			BSA_NODISCARD inline cached_file find(stl::string_view a_path) const { return find(detail::file_hasher()(a_path)); }
+
+			BSA_NODISCARD inline cached_file find(const detail::hash_t& a_hash) const noexcept { return find_key(archive::make_key(a_hash)); }
+		};
+
+		// files are found by the same hash the archive uses. see detail::vfs_base_t
+		class vfs final :
+			public detail::vfs_base_t<archive>
+		{
+		public:
+			// a_path as for archive::find
+			BSA_NODISCARD inline file_entry find(stl::string_view a_path) const { return find(detail::file_hasher()(a_path)); }
+
+			BSA_NODISCARD inline file_entry find(const detail::hash_t& a_hash) const noexcept
+			{
+				const auto archive = find_archive(a_hash);
+				return archive ? archive->find(a_hash) : file_entry();
+			}
+
+			// the archive that wins the file, or nullptr if none of them have it
+			BSA_NODISCARD inline const archive* find_archive(const detail::hash_t& a_hash) const noexcept
+			{
+				return find_key(archive::make_key(a_hash));
+			}
+
+			BSA_NODISCARD inline bool contains(stl::string_view a_path) const { return contains(detail::file_hasher()(a_path)); }
+			BSA_NODISCARD inline bool contains(const detail::hash_t& a_hash) const noexcept { return find_archive(a_hash) != nullptr; }
 		};
 	}
 }
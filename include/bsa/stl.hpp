@@ -108,6 +108,7 @@ namespace bsa
 #define BSA_NODISCARD [[nodiscard]]
 
 #include <filesystem>
+#include <memory_resource>
 #include <optional>
 #include <string_view>
 #include <variant>
@@ -149,6 +150,12 @@ namespace bsa
 
 		using std::byte;
 		using std::to_integer;
+
+		namespace pmr
+		{
+			using std::pmr::get_default_resource;
+			using std::pmr::memory_resource;
+		}
 	}
 }
 
@@ -162,6 +169,8 @@ namespace bsa
 #define BSA_MAYBE_UNUSED
 #define BSA_NODISCARD
 
+#include <boost/container/pmr/global_resource.hpp>
+#include <boost/container/pmr/memory_resource.hpp>
 #include <boost/optional.hpp>
 #include <boost/utility/string_ref.hpp>
 #include <boost/variant2/variant.hpp>
@@ -184,6 +193,12 @@ namespace bsa
 		using boost::variant2::variant;
 		using boost::variant2::visit;
 
+		namespace pmr
+		{
+			using boost::container::pmr::get_default_resource;
+			using boost::container::pmr::memory_resource;
+		}
+
 		template <class T, class U>
 		static constexpr bool is_same_v = std::is_same<T, U>::value;
 
@@ -303,6 +318,7 @@ namespace bsa
 #include <bit>
 #include <span>
 
+#define BSA_CXX20_CONSTEVAL consteval
 #define BSA_CXX20_CONSTEXPR constexpr
 #define BSA_CXX20_NOEXCEPT noexcept(true)
 
@@ -312,6 +328,7 @@ namespace bsa
 {
 	namespace stl
 	{
+		using std::countl_zero;
 		using std::rotl;
 		using std::rotr;
 		using std::ssize;
@@ -322,6 +339,7 @@ namespace bsa
 
 #else
 
+#define BSA_CXX20_CONSTEVAL constexpr
 #define BSA_CXX20_CONSTEXPR inline
 #define BSA_CXX20_NOEXCEPT noexcept(false)
 
@@ -353,6 +371,21 @@ namespace bsa
 			inline constexpr bool implements_size_v = implements_size<T>::value;
 		}
 
+		template <
+			class T,
+			stl::enable_if_t<
+				stl::is_unsigned_v<T>,
+				int> = 0>
+		BSA_NODISCARD constexpr int countl_zero(T a_val) noexcept
+		{
+			constexpr auto N = std::numeric_limits<T>::digits;
+			int count = 0;
+			for (auto bit = T{ 1 } << (N - 1); bit != 0 && (a_val & bit) == 0; bit >>= 1) {
+				++count;
+			}
+			return count;
+		}
+
 		template <class T, stl::enable_if_t<stl::is_unsigned_v<T>, int> = 0>
 		BSA_NODISCARD constexpr T rotl(T a_val, int a_pos) noexcept;
 		template <class T, stl::enable_if_t<stl::is_unsigned_v<T>, int> = 0>
@@ -417,7 +450,53 @@ namespace bsa
 			return N;
 		}
 
-		using boost::beast::span;
+		// fills in what beast's span is missing compared to std::span
+		template <class T>
+		class span :
+			public boost::beast::span<T>
+		{
+		private:
+			using super = boost::beast::span<T>;
+
+		public:
+			using super::super;
+
+			span() = default;
+			span(const span&) = default;
+
+			span(const super& a_rhs) noexcept :
+				super(a_rhs)
+			{}
+
+			template <
+				class C,
+				stl::enable_if_t<
+					std::is_convertible<decltype(std::declval<C&>().data()), T*>::value &&
+						detail::implements_size_v<C&>,
+					int> = 0>
+			span(C& a_container) noexcept :
+				super(a_container.data(), a_container.size())
+			{}
+
+			span& operator=(const span&) = default;
+
+			BSA_NODISCARD T& operator[](std::size_t a_idx) const noexcept { return this->data()[a_idx]; }
+
+			BSA_NODISCARD T* begin() const noexcept { return this->data(); }
+			BSA_NODISCARD T* end() const noexcept { return this->data() + this->size(); }
+
+			BSA_NODISCARD span first(std::size_t a_count) const noexcept { return { this->data(), a_count }; }
+
+			BSA_NODISCARD span subspan(std::size_t a_offset) const noexcept
+			{
+				return { this->data() + a_offset, this->size() - a_offset };
+			}
+
+			BSA_NODISCARD span subspan(std::size_t a_offset, std::size_t a_count) const noexcept
+			{
+				return { this->data() + a_offset, a_count };
+			}
+		};
 	}
 }
 
@@ -37,6 +37,7 @@ namespace bsa
 			class file_t;
 			class hash_t;
 			class header_t;
+			struct index_cache_traits;
 
 			class header_t final
 			{
@@ -76,7 +77,7 @@ namespace bsa
 
 				constexpr void clear() noexcept { _block = block_t(); }
 
-				inline void read(istream_t& a_input) { _block.read(a_input); }
+				inline void read(ispan_t& a_input) { _block.read(a_input); }
 
 				inline void write(ostream_t& a_output) const { _block.write(a_output); }
 
@@ -97,7 +98,7 @@ namespace bsa
 					constexpr block_t& operator=(const block_t&) noexcept = default;
 					constexpr block_t& operator=(block_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input)
+					inline void read(ispan_t& a_input)
 					{
 						a_input >>
 							version >>
@@ -144,7 +145,7 @@ namespace bsa
 						   zero_extend<std::uint64_t>(_block.hi) << 4 * byte_v;
 				}
 
-				inline void read(istream_t& a_input) { _block.read(a_input); }
+				inline void read(ispan_t& a_input) { _block.read(a_input); }
 				inline void write(ostream_t& a_output) const { _block.write(a_output); }
 
 			protected:
@@ -165,7 +166,7 @@ namespace bsa
 					constexpr block_t& operator=(const block_t&) noexcept = default;
 					constexpr block_t& operator=(block_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input)
+					inline void read(ispan_t& a_input)
 					{
 						a_input >>
 							lo >>
@@ -225,25 +226,56 @@ namespace bsa
 					return hash(view);
 				}
 
+				BSA_NODISCARD inline hash_t operator()(stl::string_view a_path) const
+				{
+					path_buffer_t buffer{ a_path.size() };
+					const auto view = normalize_path(a_path, buffer).full;
+					verify(view);
+					return hash(view);
+				}
+
+				BSA_NODISCARD inline hash_t operator()(const boost::filesystem::path& a_path) const
+				{
+					return (*this)(stl::string_view{ a_path.string() });
+				}
+
+				BSA_NODISCARD constexpr hash_t operator()(const static_path_t& a_path) const
+				{
+					const auto view = a_path.parts().full;
+					if (view.empty()) {
+						throw empty_file();
+					}
+					return hash(view);
+				}
+
 			private:
+				// rotate between first 4 bytes
+				BSA_NODISCARD static constexpr std::uint32_t step_lo(std::uint32_t a_lo, std::size_t a_pos, char a_ch) noexcept
+				{
+					return a_lo ^ (zero_extend<std::uint32_t>(a_ch) << ((a_pos % 4) * 8));
+				}
+
+				BSA_NODISCARD static constexpr std::uint32_t step_hi(std::uint32_t a_hi, std::size_t a_pos, char a_ch) noexcept
+				{
+					const auto rot = zero_extend<std::uint32_t>(a_ch) << ((a_pos % 4) * 8);
+					return stl::rotr<std::uint32_t>(a_hi ^ rot, zero_extend<int>(rot));
+				}
+
 				BSA_NODISCARD constexpr hash_t hash(stl::string_view a_fullPath) const
 				{
 					hash_t hash;
 					auto& block = hash.block_ref();
 
+					// the first half of the path goes into the low word, the rest into the high
 					const std::size_t midPoint = a_fullPath.size() >> 1;
 					std::size_t i = 0;
 					while (i < midPoint) {
-						// rotate between first 4 bytes
-						block.lo ^= zero_extend<std::uint32_t>(a_fullPath[i]) << ((i % 4) * 8);
+						block.lo = step_lo(block.lo, i, a_fullPath[i]);
 						++i;
 					}
 
-					std::uint32_t rot = 0;
 					while (i < a_fullPath.length()) {
-						// rotate between first 4 bytes
-						rot = zero_extend<std::uint32_t>(a_fullPath[i]) << (((i - midPoint) % 4) * 8);
-						block.hi = stl::rotr<std::uint32_t>(block.hi ^ rot, zero_extend<int>(rot));
+						block.hi = step_hi(block.hi, i - midPoint, a_fullPath[i]);
 						++i;
 					}
 
@@ -256,10 +288,8 @@ namespace bsa
 						throw empty_file();
 					}
 
-					for (auto& ch : a_path) {
-						if (ch < 0) {
-							throw hash_non_ascii();
-						}
+					if (!is_ascii(a_path)) {
+						throw hash_non_ascii();
 					}
 				}
 			};
@@ -279,7 +309,7 @@ namespace bsa
 				{
 					path_t path(a_relativePath);
 					_hash = file_hasher()(path);
-					_name = path.string();
+					_name.assign(path.string());
 				}
 
 				~file_t() = default;
@@ -313,7 +343,7 @@ namespace bsa
 
 				BSA_NODISCARD constexpr std::size_t size() const noexcept { return zero_extend<std::size_t>(_block.size); }
 
-				BSA_NODISCARD constexpr const std::string& string() const noexcept { return _name; }
+				BSA_NODISCARD inline stl::string_view string() const noexcept { return _name.view(); }
 
 				BSA_NODISCARD inline stl::span<const stl::byte> get_data() const
 				{
@@ -321,9 +351,9 @@ namespace bsa
 					case iview:
 						return stl::get<iview>(_data);
 					case ifile:
-						return stl::get<ifile>(_data).subspan();
+						return stl::get<ifile>(_data).view();
 					case iarchive:
-						return stl::get<iarchive>(_data).first;
+						return stl::get<iarchive>(_data);
 					case inull:
 						return {};
 					default:
@@ -343,11 +373,12 @@ namespace bsa
 
 				inline void set_data(istream_t a_input)
 				{
-					if (a_input.size() > max_int32) {
+					const auto size = a_input.size();
+					if (size > max_int32) {
 						throw size_error();
 					} else {
 						_data.emplace<ifile>(std::move(a_input));
-						_block.size = zero_extend<std::uint32_t>(a_input.size());
+						_block.size = zero_extend<std::uint32_t>(size);
 					}
 				}
 
@@ -360,31 +391,20 @@ namespace bsa
 					}
 				}
 
-				inline void read(istream_t& a_input) { _block.read(a_input); }
+				inline void read(ispan_t& a_input) { _block.read(a_input); }
 
-				inline void read_hash(istream_t& a_input) { _hash.read(a_input); }
+				inline void read_hash(ispan_t& a_input) { _hash.read(a_input); }
 
-				inline void read_name(istream_t& a_input)
-				{
-					char ch;
-					do {
-						a_input.get(ch);
-						_name.push_back(ch);
-					} while (ch != '\0');
-					_name.pop_back();  // discard null terminator
-				}
+				inline void read_name(istream_t& a_input) { _name.assign_view(a_input.read_zstring()); }
 
-				inline void read_data(istream_t& a_input)
+				// a_dataOffset is where the data block starts. the archive owns the mapping, so only
+				// the view of this file's bytes is kept
+				inline void read_data(const istream_t& a_input, std::size_t a_dataOffset)
 				{
-					const restore_point p(a_input);
-
-					a_input.seek_rel(offset());
-					_data.emplace<iarchive>(
-						a_input.subspan(size()),
-						a_input);
+					_data.emplace<iarchive>(a_input.view_at(a_dataOffset + offset(), size()));
 				}
 
-				inline void extract(std::ostream& a_file)
+				inline void extract(std::ostream& a_file) const
 				{
 					const auto data = get_data();
 					if (!data.empty()) {
@@ -426,7 +446,7 @@ namespace bsa
 				using null_type = stl::monostate;
 				using view_type = stl::span<const stl::byte>;
 				using file_type = istream_t;
-				using archive_type = std::pair<stl::span<const stl::byte>, istream_t>;
+				using archive_type = stl::span<const stl::byte>;  // into the mapping held by the archive
 
 				struct block_t final
 				{
@@ -443,7 +463,7 @@ namespace bsa
 					constexpr block_t& operator=(const block_t&) noexcept = default;
 					constexpr block_t& operator=(block_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input)
+					inline void read(ispan_t& a_input)
 					{
 						a_input >>
 							size >>
@@ -463,10 +483,11 @@ namespace bsa
 
 				hash_t _hash;
 				block_t _block;
-				std::string _name;
+				name_t _name;
 				stl::variant<null_type, view_type, file_type, archive_type> _data;
 			};
 			using file_ptr = std::shared_ptr<file_t>;
+			using index_t = index_arena<file_t>;
 
 			BSA_NODISCARD constexpr bool operator==(const file_t& a_lhs, const file_t& a_rhs) { return a_lhs.hash_ref() == a_rhs.hash_ref(); }
 			BSA_NODISCARD constexpr bool operator!=(const file_t& a_lhs, const file_t& a_rhs) { return !(a_lhs == a_rhs); }
@@ -477,6 +498,14 @@ namespace bsa
 			BSA_NODISCARD constexpr bool operator>=(const file_t& a_lhs, const file_t& a_rhs) noexcept { return !(a_lhs < a_rhs); }
 		}
 
+		class hash;
+		class index_cache;
+
+		namespace literals
+		{
+			BSA_NODISCARD BSA_CXX20_CONSTEVAL hash operator""_file(const char* a_path, std::size_t a_length);
+		}
+
 		class hash final
 		{
 		public:
@@ -511,7 +540,10 @@ namespace bsa
 			}
 
 		protected:
+			friend class archive;
 			friend class file;
+			friend class index_cache;
+			friend BSA_CXX20_CONSTEVAL hash literals::operator""_file(const char*, std::size_t);
 
 			using value_type = detail::hash_t;
 
@@ -529,6 +561,15 @@ namespace bsa
 
 		constexpr void swap(hash& a_lhs, hash& a_rhs) noexcept { a_lhs.swap(a_rhs); }
 
+		namespace literals
+		{
+			// the hash of a path worked out at compile time, i.e. "meshes\\m\\probe_journeyman_01.nif"_file
+			BSA_NODISCARD BSA_CXX20_CONSTEVAL hash operator""_file(const char* a_path, std::size_t a_length)
+			{
+				return hash{ detail::file_hasher()(detail::static_path_t{ { a_path, a_length } }) };
+			}
+		}
+
 		inline std::ostream& operator<<(std::ostream& a_ostream, const hash& a_hash)
 		{
 			a_ostream << a_hash.numeric();
@@ -590,8 +631,7 @@ namespace bsa
 					throw output_error();
 				}
 
-				auto path = a_root;
-				path /= string();
+				const auto path = detail::output_path(a_root, string());
 				boost::filesystem::create_directories(path.parent_path());
 				std::ofstream file(path.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
 				if (!file.is_open()) {
@@ -625,7 +665,7 @@ namespace bsa
 				return _impl->size();
 			}
 
-			BSA_NODISCARD inline const std::string& string() const noexcept
+			BSA_NODISCARD inline stl::string_view string() const noexcept
 			{
 				assert(exists());
 				return _impl->string();
@@ -776,6 +816,19 @@ namespace bsa
 
 		inline void swap(file_iterator& a_lhs, file_iterator& a_rhs) noexcept { a_lhs.swap(a_rhs); }
 
+		struct extract_options final
+		{
+			std::size_t threads{ 0 };  // 0 uses one thread per core
+			bool preallocate{ true };  // reserve each file's size before writing it
+
+			// when non-zero, each thread reads and writes its files through io_uring with up to this
+			// many requests in flight. where io_uring isn't available, the files are written as usual
+			std::size_t queue_depth{ 0 };
+		};
+
+		// a loaded archive can be shared between threads: the const members only read the
+		// index and the mapping, so find, iteration and extraction may run concurrently.
+		// anything that modifies the archive needs exclusive access
 		class archive final
 		{
 		public:
@@ -786,9 +839,18 @@ namespace bsa
 			archive(const archive&) = default;
 			archive(archive&&) noexcept = default;
 
-			inline archive(const boost::filesystem::path& a_path) :
+			// index entries are allocated from a_resource, which must outlive every file handle
+			// taken from the archive
+			explicit inline archive(stl::pmr::memory_resource* a_resource) noexcept :
+				_resource(a_resource)
+			{}
+
+			inline archive(const boost::filesystem::path& a_path, stl::pmr::memory_resource* a_resource = nullptr) :
 				_files(),
-				_header()
+				_fileIndex(),
+				_header(),
+				_index(),
+				_resource(a_resource)
 			{
 				read(a_path);
 			}
@@ -835,19 +897,23 @@ namespace bsa
 			inline void clear() noexcept
 			{
 				_files.clear();
+				_fileIndex.clear();
 				_header.clear();
+				_index.reset();
 			}
 
 			BSA_NODISCARD constexpr std::size_t file_count() const noexcept { return _header.file_count(); }
 			BSA_NODISCARD constexpr archive_version version() const noexcept { return _header.version(); }
 
-			inline void read(const boost::filesystem::path& a_path)
+			inline void read(const boost::filesystem::path& a_path, io_backend a_backend = io_backend::mmap)
 			{
-				detail::istream_t input(a_path);
+				detail::istream_t input(a_path, a_backend);
+				input.advise(detail::access_hint::sequential);
 
 				clear();
 
-				_header.read(input);
+				auto header = input.read_block(detail::header_t::block_size());
+				_header.read(header);
 				switch (version()) {
 				case v256:
 					break;
@@ -862,67 +928,124 @@ namespace bsa
 
 				sort();
 				update_all();
+				update_index();
 				assert(check_hashes());
+
+				// from here on files are looked up one at a time
+				input.advise(detail::access_hint::random);
 			}
 
-			inline void extract(const boost::filesystem::path& a_path)
+			inline void extract(const boost::filesystem::path& a_path, const extract_options& a_options = {}) const
 			{
 				if (!boost::filesystem::exists(a_path)) {
 					throw output_error();
 				}
 
-				boost::filesystem::path filePath;
-				std::ofstream output;
-				for (auto& file : _files) {
-					output.close();
-					filePath = a_path / file->string();
-					boost::filesystem::create_directories(filePath.parent_path());
-					output.open(filePath.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
-					if (!output.is_open()) {
-						throw output_error();
-					}
-					file->extract(output);
+				// create every directory up front so the workers only ever write files
+				std::vector<boost::filesystem::path> paths;
+				paths.reserve(_files.size());
+				for (const auto& file : _files) {
+					paths.push_back(detail::output_path(a_path, file->string()));
+				}
+
+				std::vector<boost::filesystem::path> dirs;
+				dirs.reserve(paths.size());
+				for (const auto& path : paths) {
+					dirs.push_back(path.parent_path());
+				}
+				std::sort(dirs.begin(), dirs.end());
+				dirs.erase(std::unique(dirs.begin(), dirs.end()), dirs.end());
+				for (const auto& dir : dirs) {
+					boost::filesystem::create_directories(dir);
+				}
+
+				// walk the source in the order it is laid out on disk
+				std::vector<std::size_t> order(_files.size());
+				for (std::size_t i = 0; i < order.size(); ++i) {
+					order[i] = i;
+				}
+				std::sort(order.begin(), order.end(), [&](std::size_t a_lhs, std::size_t a_rhs) {
+					return std::less<const stl::byte*>()(
+						_files[a_lhs]->get_data().data(),
+						_files[a_rhs]->get_data().data());
+				});
+
+				advise(detail::access_hint::sequential);
+				const auto batched =
+					a_options.queue_depth > 0 &&
+					detail::extract_files_batched(
+						_index ? _index->source() : detail::istream_t{},
+						order.size(),
+						a_options.threads,
+						a_options.queue_depth,
+						a_options.preallocate,
+						[&](std::size_t a_idx) {
+							const auto i = order[a_idx];
+							return std::make_pair(paths[i], _files[i]->get_data());
+						},
+						[](std::size_t, stl::span<const stl::byte> a_stored, std::vector<stl::byte>&) {
+							return a_stored;
+						});
+				if (!batched) {
+					// entries are stored as-is, so the kernel can copy them straight out of the archive
+					const detail::kernel_copier_t copier{ _index ? _index->source() : detail::istream_t{} };
+					detail::parallel_for(order.size(), a_options.threads, [&](std::size_t a_idx) {
+						const auto i = order[a_idx];
+						copier.write_file(paths[i], _files[i]->get_data(), a_options.preallocate);
+					});
 				}
+				advise(detail::access_hint::random);
 			}
 
 			inline void write(const boost::filesystem::path& a_path)
 			{
-				std::ofstream file{ a_path.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc };
-				if (!file.is_open()) {
-					throw output_error();
-				} else {
-					write(file);
-				}
+				detail::write_file(a_path, [&](osink& a_sink) { write(a_sink); });
 			}
 
 			inline void write(std::ostream& a_output)
 			{
-				detail::ostream_t output(a_output);
+				ostream_sink sink{ a_output };
+				write(sink);
+			}
 
-				update_all();
+			inline void write(osink& a_sink)
+			{
+				detail::ostream_t output(a_sink);
 
-				_header.write(output);
+				update_all();
+				write_index(output);
 				for (const auto& file : _files) {
-					file->write(output);
+					file->write_data(output);
 				}
 
-				std::uint32_t offset = 0;
-				for (const auto& file : _files) {
-					output << offset;
-					offset += detail::zero_extend<std::uint32_t>(file->name_size());
-				}
+				output.flush();
+			}
 
-				for (const auto& file : _files) {
-					file->write_name(output);
-				}
+			// produces the same bytes as write, but a_path is mapped at its final size up front
+			// and the file data is copied into place from a_threads threads (0 picks one per core)
+			inline void write_mapped(const boost::filesystem::path& a_path, std::size_t a_threads = 0)
+			{
+				update_all();
 
-				for (const auto& file : _files) {
-					file->write_hash(output);
-				}
+				detail::write_mapped(a_path, size_bytes(), [&](stl::span<stl::byte> a_dst) {
+					detail::span_sink sink{ a_dst };
+					detail::ostream_t output(sink);
+					write_index(output);
+					output.flush();
+
+					const auto dataOffset = sink.tell();
+					detail::parallel_for(_files.size(), a_threads, [&](std::size_t a_idx) {
+						const auto& file = _files[a_idx];
+						const auto pos = dataOffset + file->offset();
+						if (pos > a_dst.size() || file->size() > a_dst.size() - pos) {
+							throw output_error();
+						}
 
-				for (const auto& file : _files) {
-					file->write_data(output);
-				}
+						detail::span_sink fileSink{ { a_dst.data() + pos, file->size() } };
+						detail::ostream_t fileOutput(fileSink, 0);
+						file->write_data(fileOutput);
+					});
+				});
 			}
 
 			inline void insert(const file& a_file)
@@ -935,6 +1058,7 @@ namespace bsa
 					_files.reserve(size() + 1);
 					_files.push_back(a_file.file_ptr());
 					sort();
+					update_index();
 					update_size();
 				}
 			}
@@ -972,6 +1096,7 @@ namespace bsa
 				}
 
 				sort();
+				update_index();
 				update_size();
 			}
 
@@ -993,17 +1118,38 @@ namespace bsa
 				}
 
 				_files.erase(it);
+				update_index();
 				return true;
 			}
 
-			BSA_NODISCARD inline file find(const boost::filesystem::path& a_path)
+			BSA_NODISCARD inline file find(const boost::filesystem::path& a_path) const
 			{
 				const auto hash = detail::file_hasher()(a_path);
 				auto it = binary_find(hash);
 				return it != _files.end() ? file(*it) : file();
 			}
 
-			BSA_NODISCARD inline bool contains(const file& a_file)
+			BSA_NODISCARD inline file find(const tes3::hash& a_hash) const
+			{
+				auto it = binary_find(a_hash._impl);
+				return it != _files.end() ? file(*it) : file();
+			}
+
+			// find for every hash in a_hashes, written to the same slot in a_out. each search is
+			// branchless, so consecutive ones already overlap their cache misses
+			inline void find_all(stl::span<const tes3::hash> a_hashes, stl::span<file> a_out) const
+			{
+				if (a_out.size() < a_hashes.size()) {
+					throw size_error("not enough room for the results");
+				}
+
+				for (std::size_t i = 0; i < a_hashes.size(); ++i) {
+					const auto pos = _fileIndex.find(index_key(a_hashes[i]._impl));
+					a_out[i] = pos != detail::eytzinger_index_t::npos() ? file(_files[pos]) : file();
+				}
+			}
+
+			BSA_NODISCARD inline bool contains(const file& a_file) const
 			{
 				if (!a_file) {
 					return false;
@@ -1015,9 +1161,12 @@ namespace bsa
 			}
 
 		private:
+			friend struct detail::index_cache_traits;
+
 			using value_t = detail::file_ptr;
 			using container_t = std::vector<value_t>;
 			using iterator_t = typename container_t::iterator;
+			using const_iterator_t = typename container_t::const_iterator;
 
 			class file_sorter final
 			{
@@ -1033,13 +1182,23 @@ namespace bsa
 				}
 			};
 
+			// the files are sorted by the low half of their hash first, so the key has to be too
+			BSA_NODISCARD static constexpr std::uint64_t index_key(const detail::hash_t& a_hash) noexcept
+			{
+				return detail::zero_extend<std::uint64_t>(a_hash.low()) << 32 |
+					   detail::zero_extend<std::uint64_t>(a_hash.high());
+			}
+
 			inline iterator_t binary_find(const detail::hash_t& a_hash)
 			{
-				auto it = _files.begin();
-				const auto itEnd = _files.end();
-				it = std::lower_bound(it, itEnd, a_hash, file_sorter());
+				const auto pos = _fileIndex.find(index_key(a_hash));
+				return pos != detail::eytzinger_index_t::npos() ? _files.begin() + pos : _files.end();
+			}
 
-				return it != _files.end() && (*it)->hash_ref() == a_hash ? it : itEnd;
+			inline const_iterator_t binary_find(const detail::hash_t& a_hash) const
+			{
+				const auto pos = _fileIndex.find(index_key(a_hash));
+				return pos != detail::eytzinger_index_t::npos() ? _files.begin() + pos : _files.end();
 			}
 
 			BSA_NODISCARD inline std::size_t calc_file_size() const noexcept
@@ -1115,7 +1274,7 @@ namespace bsa
 			{
 				detail::hash_t hash;
 				for (auto& file : _files) {
-					hash = detail::file_hasher()({ file->string() });
+					hash = detail::file_hasher()(file->string());
 					if (hash != file->hash_ref()) {
 						return false;
 					}
@@ -1124,23 +1283,23 @@ namespace bsa
 				return true;
 			}
 
-			inline void read_data(detail::istream_t& a_input)
+			inline void read_data(const detail::istream_t& a_input)
 			{
 				auto pos = _header.hash_offset();
 				pos += detail::header_t::block_size();
 				pos += detail::hash_t::block_size() * file_count();
-				a_input.seek_beg(pos);
 
 				for (auto& file : _files) {
-					file->read_data(a_input);
+					file->read_data(a_input, pos);
 				}
 			}
 
 			inline void read_filenames(detail::istream_t& a_input)
 			{
 				std::vector<std::uint32_t> offsets(file_count());
+				auto block = a_input.read_block(sizeof(std::uint32_t) * file_count());
 				for (auto& offset : offsets) {
-					a_input >> offset;
+					block >> offset;
 				}
 
 				const auto pos = a_input.tell();
@@ -1156,23 +1315,66 @@ namespace bsa
 				pos += detail::header_t::block_size();
 				a_input.seek_beg(pos);
 
+				auto block = a_input.read_block(detail::hash_t::block_size() * file_count());
 				for (auto& file : _files) {
-					file->read_hash(a_input);
+					file->read_hash(block);
 				}
 			}
 
 			inline void read_initial(detail::istream_t& a_input)
 			{
+				_index = detail::index_t::create(_resource);
+				_index->reserve<detail::file_t>(file_count());
+				_index->source(a_input);
 				_files.reserve(file_count());
+				auto block = a_input.read_block(detail::file_t::block_size() * file_count());
 				for (std::size_t i = 0; i < file_count(); ++i) {
-					auto file = std::make_shared<detail::file_t>();
-					file->read(a_input);
+					auto file = detail::index_t::make<detail::file_t>(_index);
+					file->read(block);
 					_files.push_back(std::move(file));
 				}
 			}
 
 			inline void sort() { std::sort(_files.begin(), _files.end(), file_sorter()); }
 
+			// has to follow every change to the order of _files
+			inline void update_index()
+			{
+				_fileIndex.assign(_files.size(), [&](std::size_t a_idx) noexcept {
+					return index_key(_files[a_idx]->hash_ref());
+				});
+			}
+
+			inline void advise(detail::access_hint a_hint) const noexcept
+			{
+				if (_index) {
+					_index->source().advise(a_hint);
+				}
+			}
+
+			// everything up to the data block
+			inline void write_index(detail::ostream_t& a_output) const
+			{
+				_header.write(a_output);
+				for (const auto& file : _files) {
+					file->write(a_output);
+				}
+
+				std::uint32_t offset = 0;
+				for (const auto& file : _files) {
+					a_output << offset;
+					offset += detail::zero_extend<std::uint32_t>(file->name_size());
+				}
+
+				for (const auto& file : _files) {
+					file->write_name(a_output);
+				}
+
+				for (const auto& file : _files) {
+					file->write_hash(a_output);
+				}
+			}
+
 			inline void update_all()
 			{
 				update_header();
@@ -1316,7 +1518,55 @@ namespace bsa
 			}
 
 			container_t _files;
+			detail::eytzinger_index_t _fileIndex;
 			detail::header_t _header;
+			std::shared_ptr<detail::index_t> _index;
+			stl::pmr::memory_resource* _resource{ nullptr };
+		};
+
+		namespace detail
+		{
+			// how index_cache reads and records tes3 archives
+			struct index_cache_traits final
+			{
+				using archive_type = archive;
+
+				BSA_NODISCARD static constexpr cache_format format() noexcept { return cache_format::tes3; }
+
+				BSA_NODISCARD static inline archive read(const boost::filesystem::path& a_path) { return archive{ a_path }; }
+
+				static inline void add(index_cache_writer_t& a_writer, const archive& a_source)
+				{
+					auto dataOffset = a_source._header.hash_offset();
+					dataOffset += header_t::block_size();
+					dataOffset += hash_t::block_size() * a_source.file_count();
+
+					a_writer.reserve(a_source._files.size());
+					for (const auto& file : a_source._files) {
+						a_writer.add(
+							{ file->hash_ref().numeric(), 0 },
+							dataOffset + file->offset(),
+							file->size(),
+							file->size(),
+							false,
+							{},
+							file->string());
+					}
+				}
+			};
+		}
+
+		// files are keyed by the same hash the archive uses. see detail::index_cache_base_t
+		class index_cache final :
+			public detail::index_cache_base_t<detail::index_cache_traits>
+		{
+		public:
+			BSA_NODISCARD inline cached_file find(const boost::filesystem::path& a_path) const
+			{
+				return find_key({ detail::file_hasher()(a_path).numeric(), 0 });
+			}
+
+			BSA_NODISCARD inline cached_file find(const tes3::hash& a_hash) const noexcept { return find_key({ a_hash._impl.numeric(), 0 }); }
 		};
 
 		inline archive& operator<<(archive& a_archive, const boost::filesystem::path& a_path)
@@ -1342,5 +1592,11 @@ namespace bsa
 			a_archive.write(a_stream);
 			return a_archive;
 		}
+
+		inline archive& operator>>(archive& a_archive, osink& a_sink)
+		{
+			a_archive.write(a_sink);
+			return a_archive;
+		}
 	}
 }
@@ -7,6 +7,7 @@
 #include <array>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <ios>
@@ -17,6 +18,9 @@
 #include <utility>
 #include <vector>
 
+#include <lz4frame.h>
+#include <zlib.h>
+
 namespace bsa
 {
 	namespace tes4	// The Elder Scrolls IV: Oblivion
@@ -89,6 +93,19 @@ namespace bsa
 
 		BSA_MAKE_ALL_ENUM_OPERATORS(archive_type);
 
+		enum class read_option : std::uint32_t
+		{
+			none = 0,
+
+			// only the index is read up front, the prefixes stored in front of each
+			// file's data (embedded name, uncompressed size) are resolved on demand
+			defer_data = 1 << 0,
+
+			all = defer_data
+		};
+
+		BSA_MAKE_ALL_ENUM_OPERATORS(read_option);
+
 		using archive_version = std::size_t;
 		BSA_CXX17_INLINE constexpr archive_version v103{ 103 };
 		BSA_CXX17_INLINE constexpr archive_version v104{ 104 };
@@ -104,6 +121,10 @@ namespace bsa
 			class file_t;
 			class hash_t;
 			class header_t;
+			struct index_cache_traits;
+			class lz4_decompressor;
+			class zlib_deflater;
+			class zlib_inflater;
 
 			class header_t final
 			{
@@ -269,7 +290,7 @@ namespace bsa
 
 				constexpr void clear() noexcept { _block = block_t(); }
 
-				inline void read(istream_t& a_input) { _block.read(a_input); }
+				inline void read(ispan_t& a_input) { _block.read(a_input); }
 
 				inline void write(ostream_t& a_output) const { _block.write(a_output, directory_strings(), file_strings()); }
 
@@ -300,7 +321,7 @@ namespace bsa
 					constexpr block_t& operator=(const block_t&) noexcept = default;
 					constexpr block_t& operator=(block_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input)
+					inline void read(ispan_t& a_input)
 					{
 						a_input >>
 							tag >>
@@ -415,7 +436,7 @@ namespace bsa
 						zero_extend<std::uint64_t>(_block.crc) << 4 * byte_v);
 				}
 
-				inline void read(istream_t& a_input, const header_t& a_header) { _block.read(a_input, a_header); }
+				inline void read(ispan_t& a_input, const header_t& a_header) { _block.read(a_input, a_header); }
 				inline void write(ostream_t& a_output, const header_t& a_header) const { _block.write(a_output, a_header); }
 
 			protected:
@@ -440,7 +461,7 @@ namespace bsa
 					constexpr block_t& operator=(const block_t&) noexcept = default;
 					constexpr block_t& operator=(block_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input, const header_t& a_header)
+					inline void read(ispan_t& a_input, const header_t& a_header)
 					{
 						a_input >>
 							last >>
@@ -493,6 +514,258 @@ namespace bsa
 			BSA_NODISCARD constexpr bool operator<=(const hash_t& a_lhs, const hash_t& a_rhs) noexcept { return !(a_lhs > a_rhs); }
 			BSA_NODISCARD constexpr bool operator>=(const hash_t& a_lhs, const hash_t& a_rhs) noexcept { return !(a_lhs < a_rhs); }
 
+			// one inflate state per thread, which is reset between files instead of being
+			// torn down and reallocated
+			class zlib_inflater final
+			{
+			public:
+				zlib_inflater(const zlib_inflater&) = delete;
+				zlib_inflater(zlib_inflater&&) = delete;
+
+				inline ~zlib_inflater() noexcept { ::inflateEnd(std::addressof(_stream)); }
+
+				zlib_inflater& operator=(const zlib_inflater&) = delete;
+				zlib_inflater& operator=(zlib_inflater&&) = delete;
+
+				BSA_NODISCARD static inline zlib_inflater& get()
+				{
+					thread_local zlib_inflater inflater;
+					return inflater;
+				}
+
+				// a_dst must be exactly the size of the decompressed data
+				inline void inflate(stl::span<const stl::byte> a_src, stl::span<stl::byte> a_dst)
+				{
+					reset(a_src);
+					Bytef empty{ 0 };  // zlib refuses a null output buffer, even when it's not going to write to it
+					_stream.next_out = !a_dst.empty() ? reinterpret_cast<Bytef*>(a_dst.data()) : std::addressof(empty);
+					_stream.avail_out = zero_extend<uInt>(a_dst.size());
+
+					const auto result = ::inflate(std::addressof(_stream), Z_FINISH);
+					if (result != Z_STREAM_END || _stream.total_out != a_dst.size()) {
+						throw decompress_error();
+					}
+				}
+
+				// inflates through a fixed size buffer, handing each piece to a_sink
+				template <class F>
+				inline void inflate(stl::span<const stl::byte> a_src, std::size_t a_size, F a_sink)
+				{
+					reset(a_src);
+					if (_buffer.empty()) {
+						_buffer.resize(1u << 16);
+					}
+
+					auto result = Z_OK;
+					do {
+						_stream.next_out = _buffer.data();
+						_stream.avail_out = zero_extend<uInt>(_buffer.size());
+						result = ::inflate(std::addressof(_stream), Z_NO_FLUSH);
+						if (result != Z_OK && result != Z_STREAM_END) {
+							throw decompress_error();
+						}
+
+						const auto len = _buffer.size() - zero_extend<std::size_t>(_stream.avail_out);
+						a_sink(stl::span<const stl::byte>{ reinterpret_cast<const stl::byte*>(_buffer.data()), len });
+					} while (result != Z_STREAM_END);
+
+					if (_stream.total_out != a_size) {
+						throw decompress_error();
+					}
+				}
+
+			private:
+				inline zlib_inflater() :
+					_stream(),
+					_buffer()
+				{
+					_stream.zalloc = Z_NULL;
+					_stream.zfree = Z_NULL;
+					_stream.opaque = Z_NULL;
+					if (::inflateInit(std::addressof(_stream)) != Z_OK) {
+						throw decompress_error();
+					}
+				}
+
+				inline void reset(stl::span<const stl::byte> a_src)
+				{
+					if (::inflateReset(std::addressof(_stream)) != Z_OK) {
+						throw decompress_error();
+					}
+
+					_stream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(a_src.data()));
+					_stream.avail_in = zero_extend<uInt>(a_src.size());
+				}
+
+				z_stream _stream;
+				std::vector<Bytef> _buffer;
+			};
+
+			// the compressing counterpart of zlib_inflater
+			class zlib_deflater final
+			{
+			public:
+				zlib_deflater(const zlib_deflater&) = delete;
+				zlib_deflater(zlib_deflater&&) = delete;
+
+				inline ~zlib_deflater() noexcept { ::deflateEnd(std::addressof(_stream)); }
+
+				zlib_deflater& operator=(const zlib_deflater&) = delete;
+				zlib_deflater& operator=(zlib_deflater&&) = delete;
+
+				BSA_NODISCARD static inline zlib_deflater& get()
+				{
+					thread_local zlib_deflater deflater;
+					return deflater;
+				}
+
+				inline void deflate(stl::span<const stl::byte> a_src, std::vector<stl::byte>& a_dst)
+				{
+					if (::deflateReset(std::addressof(_stream)) != Z_OK) {
+						throw output_error();
+					}
+
+					a_dst.resize(::deflateBound(std::addressof(_stream), zero_extend<uLong>(a_src.size())));
+					_stream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(a_src.data()));
+					_stream.avail_in = zero_extend<uInt>(a_src.size());
+					_stream.next_out = reinterpret_cast<Bytef*>(a_dst.data());
+					_stream.avail_out = zero_extend<uInt>(a_dst.size());
+
+					if (::deflate(std::addressof(_stream), Z_FINISH) != Z_STREAM_END) {
+						throw output_error();
+					}
+
+					a_dst.resize(zero_extend<std::size_t>(_stream.total_out));
+				}
+
+			private:
+				inline zlib_deflater() :
+					_stream()
+				{
+					_stream.zalloc = Z_NULL;
+					_stream.zfree = Z_NULL;
+					_stream.opaque = Z_NULL;
+					if (::deflateInit(std::addressof(_stream), Z_DEFAULT_COMPRESSION) != Z_OK) {
+						throw output_error();
+					}
+				}
+
+				z_stream _stream;
+			};
+
+			// frame compression keeps its state on the stack, so there's nothing to reuse
+			inline void lz4_compress(stl::span<const stl::byte> a_src, std::vector<stl::byte>& a_dst)
+			{
+				a_dst.resize(::LZ4F_compressFrameBound(a_src.size(), nullptr));
+				const auto result = ::LZ4F_compressFrame(a_dst.data(), a_dst.size(), a_src.data(), a_src.size(), nullptr);
+				if (::LZ4F_isError(result)) {
+					throw output_error();
+				}
+
+				a_dst.resize(result);
+			}
+
+			// the lz4 counterpart of zlib_inflater, used by v105 archives
+			class lz4_decompressor final
+			{
+			public:
+				lz4_decompressor(const lz4_decompressor&) = delete;
+				lz4_decompressor(lz4_decompressor&&) = delete;
+
+				inline ~lz4_decompressor() noexcept { ::LZ4F_freeDecompressionContext(_context); }
+
+				lz4_decompressor& operator=(const lz4_decompressor&) = delete;
+				lz4_decompressor& operator=(lz4_decompressor&&) = delete;
+
+				BSA_NODISCARD static inline lz4_decompressor& get()
+				{
+					thread_local lz4_decompressor decompressor;
+					return decompressor;
+				}
+
+				// a_dst must be exactly the size of the decompressed data
+				inline void decompress(stl::span<const stl::byte> a_src, stl::span<stl::byte> a_dst)
+				{
+					::LZ4F_decompressOptions_t options{};
+					options.stableDst = 1;	// decode straight into a_dst, without staging blocks
+
+					const auto out = run(a_src, options, [&](std::size_t a_pos) noexcept {
+						return stl::span<stl::byte>{ a_dst.data() + a_pos, a_dst.size() - a_pos };
+					});
+
+					if (out != a_dst.size()) {
+						throw decompress_error();
+					}
+				}
+
+				// decompresses through a fixed size buffer, handing each piece to a_sink
+				template <class F>
+				inline void decompress(stl::span<const stl::byte> a_src, std::size_t a_size, F a_sink)
+				{
+					if (_buffer.empty()) {
+						_buffer.resize(1u << 16);
+					}
+
+					::LZ4F_decompressOptions_t options{};
+					std::size_t flushed = 0;
+					const auto out = run(a_src, options, [&](std::size_t a_pos) {
+						if (a_pos != flushed) {
+							a_sink(stl::span<const stl::byte>{ _buffer.data(), a_pos - flushed });
+							flushed = a_pos;
+						}
+						return stl::span<stl::byte>{ _buffer.data(), _buffer.size() };
+					});
+
+					if (out != flushed) {
+						a_sink(stl::span<const stl::byte>{ _buffer.data(), out - flushed });
+					}
+
+					if (out != a_size) {
+						throw decompress_error();
+					}
+				}
+
+			private:
+				inline lz4_decompressor() :
+					_context(nullptr),
+					_buffer()
+				{
+					const auto result = ::LZ4F_createDecompressionContext(std::addressof(_context), LZ4F_VERSION);
+					if (::LZ4F_isError(result)) {
+						throw decompress_error();
+					}
+				}
+
+				// a_window is called with the total output so far, and returns where to write next
+				template <class F>
+				inline std::size_t run(stl::span<const stl::byte> a_src, const ::LZ4F_decompressOptions_t& a_options, F a_window)
+				{
+					::LZ4F_resetDecompressionContext(_context);
+
+					std::size_t in = 0;
+					std::size_t out = 0;
+					std::size_t hint = 1;
+					while (hint != 0) {
+						const auto dst = a_window(out);
+						auto srcSize = a_src.size() - in;
+						auto dstSize = dst.size();
+						hint = ::LZ4F_decompress(_context, dst.data(), std::addressof(dstSize), a_src.data() + in, std::addressof(srcSize), std::addressof(a_options));
+						if (::LZ4F_isError(hint) ||
+							(hint != 0 && srcSize == 0 && dstSize == 0)) {	// truncated
+							throw decompress_error();
+						}
+
+						in += srcSize;
+						out += dstSize;
+					}
+
+					return out;
+				}
+
+				owner<::LZ4F_dctx*> _context;
+				std::vector<stl::byte> _buffer;
+			};
+
 			class file_t final
 			{
 			public:
@@ -500,6 +773,15 @@ namespace bsa
 				file_t(const file_t&) = default;
 				file_t(file_t&&) noexcept = default;
 
+				inline file_t(std::string a_name, hash_t a_hash, archive_version a_version) noexcept :
+					_hash(a_hash),
+					_block(),
+					_name(std::move(a_name)),
+					_data(),
+					_uncompressedSize(),
+					_version(a_version)
+				{}
+
 				~file_t() = default;
 
 				file_t& operator=(const file_t&) = default;
@@ -527,6 +809,8 @@ namespace bsa
 
 				BSA_NODISCARD constexpr bool compressed() const noexcept { return _block.compressed; }
 
+				BSA_NODISCARD constexpr bool deferred() const noexcept { return _data.index() == ideferred; }
+
 				BSA_NODISCARD constexpr bool empty() const noexcept
 				{
 					switch (_data.index()) {
@@ -543,10 +827,29 @@ namespace bsa
 				BSA_NODISCARD constexpr hash_t& hash_ref() noexcept { return _hash; }
 				BSA_NODISCARD constexpr const hash_t& hash_ref() const noexcept { return _hash; }
 
-				BSA_NODISCARD BSA_CXX20_CONSTEXPR std::size_t name_size() const noexcept { return _name.size() + 1; }
+				BSA_NODISCARD inline std::size_t name_size() const noexcept { return _name.size() + 1; }
 
 				BSA_NODISCARD constexpr std::size_t offset() const noexcept { return zero_extend<std::size_t>(_block.offset); }
 
+				// where the data itself starts in a_archive, past the name and size prefixes that
+				// offset() includes. files that weren't read from a_archive just give offset()
+				BSA_NODISCARD inline std::size_t data_offset(const istream_t& a_archive) const
+				{
+					switch (_data.index()) {
+					case iarchive:
+						{
+							const auto data = stl::get<iarchive>(_data);
+							return !data.empty() ?
+									   offset() + static_cast<std::size_t>(data.data() - a_archive.view_at(offset(), 1).data()) :
+									   offset();
+						}
+					case ideferred:
+						return offset() + deferred_prefix_size();
+					default:
+						return offset();
+					}
+				}
+
 				constexpr void offset(std::size_t a_offset)
 				{
 					if (a_offset > max_int32) {
@@ -556,16 +859,30 @@ namespace bsa
 					}
 				}
 
-				BSA_NODISCARD constexpr std::size_t size() const noexcept { return zero_extend<std::size_t>(_block.size); }
+				BSA_NODISCARD inline std::size_t size() const noexcept
+				{
+					return deferred() ?
+							   zero_extend<std::size_t>(_block.size) - deferred_prefix_size() :
+							   zero_extend<std::size_t>(_block.size);
+				}
 
-				BSA_NODISCARD constexpr std::size_t uncompressed_size() const noexcept
+				BSA_NODISCARD inline std::size_t uncompressed_size() const noexcept
 				{
+					if (deferred() && compressed()) {
+						const auto& deferred = stl::get<ideferred>(_data);
+						const auto pos = deferred_name_size();
+						if (pos + sizeof(std::uint32_t) <= deferred.raw.size()) {
+							return zero_extend<std::size_t>(
+								load<std::uint32_t>(deferred.raw.data() + pos, endian::little));
+						}
+					}
+
 					return _uncompressedSize ?
 							   zero_extend<std::size_t>(*_uncompressedSize) :
-							   zero_extend<std::size_t>(_block.size);
+							   size();
 				}
 
-				BSA_NODISCARD constexpr const std::string& string() const noexcept { return _name; }
+				BSA_NODISCARD inline stl::string_view string() const noexcept { return _name.view(); }
 
 				BSA_NODISCARD inline stl::span<const stl::byte> get_data() const
 				{
@@ -573,9 +890,20 @@ namespace bsa
 					case iview:
 						return stl::get<iview>(_data);
 					case ifile:
-						return stl::get<ifile>(_data).subspan();
+						return stl::get<ifile>(_data).view();
 					case iarchive:
-						return stl::get<iarchive>(_data).first;
+						return stl::get<iarchive>(_data);
+					case ibuffer:
+						{
+							const auto& buffer = stl::get<ibuffer>(_data);
+							return { buffer.data(), buffer.size() };
+						}
+					case ideferred:
+						{
+							const auto& raw = stl::get<ideferred>(_data).raw;
+							const auto prefix = deferred_prefix_size();
+							return { raw.data() + prefix, raw.size() - prefix };
+						}
 					case inull:
 						return {};
 					default:
@@ -583,89 +911,177 @@ namespace bsa
 					}
 				}
 
-				inline void set_data(stl::span<const stl::byte> a_data, bool a_compressed)
+				// a_uncompressedSize is only given for data that's already compressed with the
+				// codec of the file's version, and is the size it decompresses to
+				inline void set_data(stl::span<const stl::byte> a_data, stl::optional<std::size_t> a_uncompressedSize)
 				{
 					if (a_data.size() > max_int32) {
 						throw size_error();
 					} else {
+						set_uncompressed_size(a_uncompressedSize);
 						_data.emplace<iview>(std::move(a_data));
 						_block.size = zero_extend<std::uint32_t>(a_data.size());
-						_block.compressed = a_compressed;
+					}
+				}
 
-						if (a_compressed) {
-							_uncompressedSize.emplace(_block.size);	 // TODO: Get actual uncompressed size
-						} else {
-							_uncompressedSize.reset();
-						}
+				// replaces the uncompressed data with its compressed form, using the
+				// codec of the given archive version
+				inline void compress(archive_version a_version)
+				{
+					if (compressed()) {
+						return;
+					}
+
+					const auto data = get_data();
+					if (data.size() > max_int32) {
+						throw size_error();
+					}
+
+					std::vector<stl::byte> buffer;
+					switch (a_version) {
+					case v103:
+					case v104:
+						zlib_deflater::get().deflate(data, buffer);
+						break;
+					case v105:
+						lz4_compress(data, buffer);
+						break;
+					default:
+						throw version_error();
+					}
+
+					if (buffer.size() > max_int32) {
+						throw size_error();
 					}
+
+					_uncompressedSize.emplace(zero_extend<std::uint32_t>(data.size()));
+					_block.size = zero_extend<std::uint32_t>(buffer.size());
+					_block.compressed = true;
+					_version = a_version;
+					_data.emplace<ibuffer>(std::move(buffer));
 				}
 
-				inline void set_data(istream_t a_input, bool a_compressed)
+				inline void set_data(istream_t a_input, stl::optional<std::size_t> a_uncompressedSize)
 				{
-					if (a_input.size() > max_int32) {
+					const auto size = a_input.size();
+					if (size > max_int32) {
 						throw size_error();
 					} else {
+						set_uncompressed_size(a_uncompressedSize);
 						_data.emplace<ifile>(std::move(a_input));
-						_block.size = zero_extend<std::uint32_t>(a_input.size());
-						_block.compressed = a_compressed;
-
-						if (a_compressed) {
-							_uncompressedSize.emplace(_block.size);	 // TODO: Get actual uncompressed size
-						} else {
-							_uncompressedSize.reset();
-						}
+						_block.size = zero_extend<std::uint32_t>(size);
 					}
 				}
 
-				inline void read(istream_t& a_input, const header_t& a_header)
+				inline void read(ispan_t& a_input, const header_t& a_header)
 				{
 					_hash.read(a_input, a_header);
 					_block.read(a_input, a_header);
+					_version = a_header.version();
 				}
 
-				inline void read_name(istream_t& a_input)
+				inline void read_name(istream_t& a_input) { _name.assign_view(a_input.read_zstring()); }
+
+				inline void read_data(const istream_t& a_input, const header_t& a_header)
 				{
-					char ch;
-					do {
-						a_input.get(ch);
-						_name.push_back(ch);
-					} while (ch != '\0');
-					_name.pop_back();  // discard null terminator
+					read_data(raw_data(a_input), a_header.embedded_file_names());
 				}
 
-				inline void read_data(istream_t& a_input, const header_t& a_header)
+				// remembers where the data lives without touching it, the prefixes are
+				// parsed from the mapping whenever they're needed
+				inline void defer_data(const istream_t& a_input, const header_t& a_header)
 				{
-					const restore_point p(a_input);
+					_data.emplace<ideferred>(deferred_type{ raw_data(a_input), a_header.embedded_file_names() });
+				}
 
-					a_input.seek_abs(offset());
+				inline void resolve_data()
+				{
+					if (deferred()) {
+						const auto deferred = stl::get<ideferred>(_data);
+						read_data(deferred.raw, deferred.embeddedFileNames);
+					}
+				}
 
-					if (a_header.embedded_file_names()) {
-						std::uint8_t len{ 0 };
-						a_input >> len;
-						a_input.seek_rel(len);
-						_block.size -= (std::min)(_block.size, zero_extend<std::uint32_t>(len + 1));
+				// a_raw is the whole record, i.e. the optional name and uncompressed size
+				// prefixes followed by the data
+				inline void read_data(stl::span<const stl::byte> a_raw, bool a_embeddedFileNames)
+				{
+					std::size_t pos = 0;
+					if (a_embeddedFileNames && !a_raw.empty()) {
+						pos += 1 + zero_extend<std::size_t>(*a_raw.data());	 // bstring
 					}
 
 					if (compressed()) {
-						std::uint32_t t{ 0 };
-						a_input >> t;
-						_uncompressedSize.emplace(t);
-						_block.size -= (std::min<std::uint32_t>)(_block.size, 4);
+						if (pos + sizeof(std::uint32_t) > a_raw.size()) {
+							throw input_error();
+						}
+						_uncompressedSize.emplace(load<std::uint32_t>(a_raw.data() + pos, endian::little));
+						pos += sizeof(std::uint32_t);
+					}
+
+					pos = (std::min)(pos, a_raw.size());
+					_block.size = zero_extend<std::uint32_t>(a_raw.size() - pos);
+					_data.emplace<iarchive>(view_type{ a_raw.data() + pos, a_raw.size() - pos });
+				}
+
+				// a_dst must be able to hold uncompressed_size() bytes
+				inline void extract(stl::span<stl::byte> a_dst) const
+				{
+					decode(get_data(), a_dst);
+				}
+
+				// extract, for a copy of get_data() that was read from elsewhere
+				inline void decode(stl::span<const stl::byte> a_data, stl::span<stl::byte> a_dst) const
+				{
+					const auto usize = uncompressed_size();
+					if (a_dst.size() < usize) {
+						throw size_error();
 					}
 
-					_data.emplace<iarchive>(
-						a_input.subspan(size()),
-						a_input);
+					const stl::span<stl::byte> dst{ a_dst.data(), usize };
+					if (compressed()) {
+						switch (_version) {
+						case v103:
+						case v104:
+							zlib_inflater::get().inflate(a_data, dst);
+							break;
+						case v105:
+							lz4_decompressor::get().decompress(a_data, dst);
+							break;
+						default:
+							throw version_error();
+						}
+					} else if (!a_data.empty()) {
+						std::memcpy(dst.data(), a_data.data(), usize);
+					}
 				}
 
-				inline void extract(std::ostream& a_file)
+				inline void extract(std::ostream& a_file) const
 				{
 					const auto data = get_data();
-					if (!data.empty()) {
+					if (data.empty()) {
+						throw output_error();
+					}
+
+					if (compressed()) {
+						const auto write = [&](stl::span<const stl::byte> a_data) {
+							a_file.write(reinterpret_cast<const char*>(a_data.data()), zero_extend<std::streamsize>(a_data.size()));
+						};
+
+						switch (_version) {
+						case v103:
+						case v104:
+							zlib_inflater::get().inflate(data, uncompressed_size(), write);
+							break;
+						case v105:
+							lz4_decompressor::get().decompress(data, uncompressed_size(), write);
+							break;
+						default:
+							throw version_error();
+						}
+					} else {
 						const auto ssize = zero_extend<std::streamsize>(size());
 						a_file.write(reinterpret_cast<const char*>(data.data()), ssize);
-					} else {
-						throw output_error();
 					}
 
 					if (!a_file) {
@@ -676,7 +1092,7 @@ namespace bsa
 				inline void write(ostream_t& a_output, const header_t& a_header, std::size_t a_dirLength) const
 				{
 					_hash.write(a_output, a_header);
-					_block.write(a_output, a_header, a_dirLength, _name.length());
+					_block.write(a_output, a_header, a_dirLength, _name.size());
 				}
 
 				inline void write_name(ostream_t& a_output) const
@@ -684,16 +1100,16 @@ namespace bsa
 					a_output << stl::string_view{ _name.data(), name_size() };
 				}
 
-				inline void write_data(ostream_t& a_output, const header_t& a_header, const std::string& a_dirPath) const
+				inline void write_data(ostream_t& a_output, const header_t& a_header, stl::string_view a_dirPath) const
 				{
 					if (a_header.embedded_file_names()) {  // bstring
 						std::size_t length = a_dirPath.length();
 						length += 1;  // directory separator
-						length += _name.length();
+						length += _name.size();
 						a_output << zero_extend<std::uint8_t>(length);
-						a_output << stl::string_view{ a_dirPath };
+						a_output << a_dirPath;
 						a_output << '\\';
-						a_output << stl::string_view{ _name };
+						a_output << _name.view();
 					}
 
 					if (compressed()) {
@@ -714,13 +1130,61 @@ namespace bsa
 					inull,
 					iview,
 					ifile,
-					iarchive
+					iarchive,
+					ibuffer,
+					ideferred
 				};
 
 				using null_type = stl::monostate;
 				using view_type = stl::span<const stl::byte>;
 				using file_type = istream_t;
-				using archive_type = std::pair<stl::span<const stl::byte>, istream_t>;
+				using archive_type = stl::span<const stl::byte>;  // into the mapping held by the archive
+				using buffer_type = std::vector<stl::byte>;
+
+				struct deferred_type final
+				{
+					stl::span<const stl::byte> raw;	 // prefixes + data, as sized by the file record
+					bool embeddedFileNames;
+				};
+
+				inline void set_uncompressed_size(stl::optional<std::size_t> a_size)
+				{
+					if (a_size && *a_size > max_int32) {
+						throw size_error();
+					}
+
+					_block.compressed = static_cast<bool>(a_size);
+					if (a_size) {
+						_uncompressedSize.emplace(zero_extend<std::uint32_t>(*a_size));
+					} else {
+						_uncompressedSize.reset();
+					}
+				}
+
+				BSA_NODISCARD inline view_type raw_data(const istream_t& a_input) const
+				{
+					return a_input.view_at(offset(), zero_extend<std::size_t>(_block.size));
+				}
+
+				BSA_NODISCARD inline std::size_t deferred_name_size() const noexcept
+				{
+					const auto& deferred = stl::get<ideferred>(_data);
+					if (deferred.embeddedFileNames && !deferred.raw.empty()) {
+						return 1 + zero_extend<std::size_t>(*deferred.raw.data());	// bstring
+					} else {
+						return 0;
+					}
+				}
+
+				BSA_NODISCARD inline std::size_t deferred_prefix_size() const noexcept
+				{
+					auto sz = deferred_name_size();
+					if (compressed()) {
+						sz += 4;
+					}
+
+					return (std::min)(sz, zero_extend<std::size_t>(_block.size));
+				}
 
 				struct block_t final  // BSFileEntry
 				{
@@ -744,7 +1208,7 @@ namespace bsa
 					constexpr block_t& operator=(const block_t&) noexcept = default;
 					constexpr block_t& operator=(block_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input, const header_t& a_header)
+					inline void read(ispan_t& a_input, const header_t& a_header)
 					{
 						a_input >>
 							size >>
@@ -784,16 +1248,18 @@ namespace bsa
 
 				hash_t _hash;
 				block_t _block;
-				std::string _name;
-				stl::variant<null_type, view_type, file_type, archive_type> _data;
+				name_t _name;
+				stl::variant<null_type, view_type, file_type, archive_type, buffer_type, deferred_type> _data;
 				stl::optional<std::uint32_t> _uncompressedSize;	 // TODO: size() == compressed or uncompressed size?
+				archive_version _version{ v104 };	 // selects the codec
 			};
 			using file_ptr = std::shared_ptr<file_t>;
+			using index_t = index_arena<directory_t, file_t>;
 
 			class directory_t final
 			{
 			public:
-				using container_type = std::vector<file_ptr>;
+				using container_type = std::vector<file_t*>;  // owned by the archive's index_t
 				using iterator = typename container_type::iterator;
 				using const_iterator = typename container_type::const_iterator;
 
@@ -802,6 +1268,13 @@ namespace bsa
 				directory_t(const directory_t&) = default;
 				directory_t(directory_t&&) noexcept = default;
 
+				inline directory_t(std::string a_name, hash_t a_hash) noexcept :
+					_hash(a_hash),
+					_block(),
+					_name(std::move(a_name)),
+					_files()
+				{}
+
 				~directory_t() = default;
 
 				directory_t& operator=(const directory_t&) = default;
@@ -838,10 +1311,10 @@ namespace bsa
 				BSA_NODISCARD constexpr hash_t& hash_ref() noexcept { return _hash; }
 				BSA_NODISCARD constexpr const hash_t& hash_ref() const noexcept { return _hash; }
 
-				BSA_NODISCARD BSA_CXX20_CONSTEXPR std::size_t name_size() const noexcept { return _name.size() + 1; }
+				BSA_NODISCARD inline std::size_t name_size() const noexcept { return _name.size() + 1; }
 
-				BSA_NODISCARD inline std::string str() const { return _name; }
-				BSA_NODISCARD constexpr const std::string& str_ref() const noexcept { return _name; }
+				BSA_NODISCARD inline std::string str() const { return _name.str(); }
+				BSA_NODISCARD inline stl::string_view str_ref() const noexcept { return _name.view(); }
 
 				BSA_NODISCARD inline iterator begin() noexcept { return _files.begin(); }
 				BSA_NODISCARD inline const_iterator begin() const noexcept { return _files.begin(); }
@@ -855,12 +1328,29 @@ namespace bsa
 
 				inline void sort() { std::sort(_files.begin(), _files.end(), file_sorter()); }
 
-				inline void read(istream_t& a_input, const header_t& a_header)
+				// keeps the files sorted, and fails if the hash is already taken
+				inline bool insert(file_t* a_file)
+				{
+					if (_files.size() + 1 > max_int32) {
+						throw size_error();
+					}
+
+					const auto it = std::lower_bound(_files.begin(), _files.end(), a_file->hash_ref(), file_sorter());
+					if (it != _files.end() && (*it)->hash_ref() == a_file->hash_ref()) {
+						return false;
+					}
+
+					_files.insert(it, a_file);
+					_block.fileCount = zero_extend<std::uint32_t>(_files.size());
+					return true;
+				}
+
+				inline void read(ispan_t& a_input, const istream_t& a_archive, const header_t& a_header, const std::shared_ptr<index_t>& a_index)
 				{
 					_hash.read(a_input, a_header);
 					_block.read(a_input, a_header);
 					if (a_header.directory_strings() || file_count() > 0) {
-						read_extra(a_input, a_header);
+						read_extra(a_archive, a_header, a_index);
 					}
 				}
 
@@ -871,13 +1361,20 @@ namespace bsa
 					}
 				}
 
-				inline void read_file_data(istream_t& a_input, const header_t& a_header)
+				inline void read_file_data(const istream_t& a_input, const header_t& a_header)
 				{
 					for (auto& file : _files) {
 						file->read_data(a_input, a_header);
 					}
 				}
 
+				inline void defer_file_data(const istream_t& a_input, const header_t& a_header)
+				{
+					for (auto& file : _files) {
+						file->defer_data(a_input, a_header);
+					}
+				}
+
 				inline void write(ostream_t& a_output, const header_t& a_header) const
 				{
 					_hash.write(a_output, a_header);
@@ -893,7 +1390,7 @@ namespace bsa
 					}
 
 					for (const auto& file : _files) {
-						file->write(a_output, a_header, _name.length());
+						file->write(a_output, a_header, _name.size());
 					}
 				}
 
@@ -907,7 +1404,7 @@ namespace bsa
 				inline void write_file_data(ostream_t& a_output, const header_t& a_header) const
 				{
 					for (const auto& file : _files) {
-						file->write_data(a_output, a_header, _name);
+						file->write_data(a_output, a_header, _name.view());
 					}
 				}
 
@@ -915,7 +1412,7 @@ namespace bsa
 				class file_sorter final
 				{
 				public:
-					using value_type = detail::file_ptr;
+					using value_type = const file_t*;
 
 					BSA_NODISCARD inline bool operator()(const value_type& a_lhs, const value_type& a_rhs) const noexcept
 					{
@@ -950,7 +1447,7 @@ namespace bsa
 					constexpr block_t& operator=(const block_t&) noexcept = default;
 					constexpr block_t& operator=(block_t&&) noexcept = default;
 
-					inline void read(istream_t& a_input, const header_t& a_header)
+					inline void read(ispan_t& a_input, const header_t& a_header)
 					{
 						switch (a_header.version()) {
 						case v103:
@@ -1013,30 +1510,34 @@ namespace bsa
 #endif
 				};
 
-				inline void read_extra(istream_t& a_input, const header_t& a_header)
+				inline void read_extra(const istream_t& a_input, const header_t& a_header, const std::shared_ptr<index_t>& a_index)
 				{
-					const restore_point p(a_input);
-					a_input.seek_beg(file_offset() - a_header.file_names_length());
+					auto pos = file_offset() - a_header.file_names_length();
 
 					if (a_header.directory_strings()) {
 						std::uint8_t length;
-						a_input >> length;
-						const auto xLength = zero_extend<std::size_t>(length) - 1;	// skip null terminator
-						_name.resize(xLength);
-						a_input.read(_name.begin(), xLength);
-						a_input.seek_rel(1);
+						a_input.view_block(pos, 1) >> length;
+						const auto name = a_input.view_block(pos + 1, length).read_view(length);
+						pos += 1 + zero_extend<std::size_t>(length);
+						if (!name.empty() && name.back() == '\0') {
+							_name.assign_view(name.substr(0, name.size() - 1));
+						} else {  // no terminator to point c_str() at
+							_name.assign(std::string(name.data(), name.size() - (std::min<std::size_t>)(name.size(), 1)));
+						}
 					}
 
+					auto block = a_input.view_block(pos, file_t::block_size() * file_count());
+					_files.reserve(file_count());
 					for (std::size_t i = 0; i < file_count(); ++i) {
-						auto file = std::make_shared<file_t>();
-						file->read(a_input, a_header);
-						_files.push_back(std::move(file));
+						auto file = a_index->construct<file_t>();
+						file->read(block, a_header);
+						_files.push_back(file);
 					}
 				}
 
 				hash_t _hash;
 				block_t _block;
-				std::string _name;	// bzstring
+				name_t _name;  // bzstring
 				container_type _files;
 			};
 			using directory_ptr = std::shared_ptr<directory_t>;
@@ -1056,24 +1557,58 @@ namespace bsa
 				BSA_NODISCARD inline hash_t operator()(stl::string_view a_path) const
 				{
 					verify_path(a_path);
-					auto fullPath = normalize(std::move(a_path));
-					return hash(fullPath);
+					path_buffer_t buffer{ a_path.size() };
+					const auto fullPath = normalize_path(a_path, buffer).full;
+					return hash(!fullPath.empty() ? fullPath : ".");
+				}
+
+				BSA_NODISCARD constexpr hash_t operator()(const static_path_t& a_path) const
+				{
+					const auto fullPath = a_path.parts().full;
+					return hash(!fullPath.empty() ? fullPath : ".");
 				}
 
 			protected:
 				friend class file_hasher;
 
-				BSA_NODISCARD inline hash_t hash(stl::string_view a_fullPath) const
+				BSA_NODISCARD static constexpr std::uint32_t step(std::uint32_t a_crc, char a_ch) noexcept
 				{
-					constexpr auto LEN_MAX{
-						zero_extend<std::size_t>(
-							(std::numeric_limits<std::int8_t>::max)())
-					};
+					return a_ch + a_crc * HASH_CONSTANT;
+				}
 
-					hash_t hash;
-					auto& block = hash.block_ref();
-					switch (std::min<std::size_t>(a_fullPath.length(), 3)) {
-					case 3:
+				// the chars that go into the crc, which skips the first and last two
+				BSA_NODISCARD static constexpr stl::string_view middle(stl::string_view a_fullPath) noexcept
+				{
+					return a_fullPath.length() > 3 ?
+						  a_fullPath.substr(1, a_fullPath.length() - 3) :
+						  stl::string_view{};
+				}
+
+				BSA_NODISCARD static constexpr std::uint32_t fold(stl::string_view a_string) noexcept
+				{
+					std::uint32_t crc = 0;
+					for (const auto& ch : a_string) {
+						crc = step(crc, ch);
+					}
+					return crc;
+				}
+
+				BSA_NODISCARD constexpr hash_t hash(stl::string_view a_fullPath) const
+				{
+					return hash(a_fullPath, fold(middle(a_fullPath)));
+				}
+
+				BSA_NODISCARD constexpr hash_t hash(stl::string_view a_fullPath, std::uint32_t a_crc) const
+				{
+					constexpr auto LEN_MAX{
+						zero_extend<std::size_t>(
+							(std::numeric_limits<std::int8_t>::max)())
+					};
+
+					hash_t hash;
+					auto& block = hash.block_ref();
+					switch (std::min<std::size_t>(a_fullPath.length(), 3)) {
+					case 3:
 						block.last2 = a_fullPath[a_fullPath.length() - 2];
 						BSA_FALLTHROUGH;
 					case 2:
@@ -1088,51 +1623,19 @@ namespace bsa
 					block.length =
 						zero_extend<std::int8_t>(
 							(std::min)(a_fullPath.length(), LEN_MAX));
-					if (block.length <= 3) {
-						return hash;
-					}
-
-					// skip first and last two chars
-					for (auto it = a_fullPath.begin() + 1; it != a_fullPath.end() - 2; ++it) {
-						block.crc = *it + block.crc * HASH_CONSTANT;
-					}
+					block.crc = a_crc;
 
 					return hash;
 				}
 
-				inline constexpr void verify_path(const stl::string_view& a_path) const
+				inline void verify_path(const stl::string_view& a_path) const
 				{
-					for (auto& ch : a_path) {
-						if (ch < 0) {
-							throw hash_non_ascii();
-						}
+					if (!is_ascii(a_path)) {
+						throw hash_non_ascii();
 					}
 				}
 
 				static constexpr auto HASH_CONSTANT{ zero_extend<std::uint32_t>(0x1003F) };
-
-			private:
-				BSA_NODISCARD inline std::string normalize(stl::string_view a_path) const
-				{
-					boost::filesystem::path path{ a_path.begin(), a_path.end() };
-					path = path.lexically_normal();
-
-					auto fullPath = path.string();
-					for (auto& ch : fullPath) {
-						ch = mapchar(ch);
-					}
-					if (fullPath.empty()) {
-						fullPath.push_back('.');
-					}
-					while (!fullPath.empty() && fullPath.back() == '\\') {
-						fullPath.pop_back();
-					}
-					while (!fullPath.empty() && fullPath.front() == '\\') {
-						fullPath = fullPath.substr(1);
-					}
-
-					return fullPath;
-				}
 			};
 
 			class file_hasher final
@@ -1150,10 +1653,15 @@ namespace bsa
 				BSA_NODISCARD inline hash_t operator()(stl::string_view a_path) const
 				{
 					_dirHasher.verify_path(a_path);
-					std::string stem;
-					std::string extension;
-					std::tie(stem, extension) = normalize(a_path);
-					return hash(stem, extension);
+					path_buffer_t buffer{ a_path.size() };
+					const auto parts = normalize_path(a_path, buffer);
+					return hash(parts.stem, parts.extension);
+				}
+
+				BSA_NODISCARD constexpr hash_t operator()(const static_path_t& a_path) const
+				{
+					const auto& parts = a_path.parts();
+					return hash(parts.stem, parts.extension);
 				}
 
 			private:
@@ -1173,31 +1681,20 @@ namespace bsa
 					return zero_extend<std::uint32_t>(tmp);
 				}
 
-				BSA_NODISCARD inline std::pair<std::string, std::string> normalize(stl::string_view a_path) const
+				BSA_NODISCARD constexpr hash_t hash(stl::string_view a_stem, stl::string_view a_extension) const
 				{
-					boost::filesystem::path path{ a_path.begin(), a_path.end() };
-					path = path.lexically_normal();
-
-					std::string stem;
-					if (path.has_stem()) {
-						stem = path.stem().string();
-						for (auto& ch : stem) {
-							ch = mapchar(ch);
-						}
-					}
-
-					std::string extension;
-					if (path.has_extension()) {
-						extension = path.extension().string();
-						for (auto& ch : extension) {
-							ch = mapchar(ch);
-						}
-					}
-
-					return std::make_pair(std::move(stem), std::move(extension));
-				}
-
-				BSA_NODISCARD inline hash_t hash(stl::string_view a_stem, stl::string_view a_extension) const
+					return hash(
+						a_stem,
+						a_extension,
+						dir_hasher::fold(dir_hasher::middle(a_stem)),
+						dir_hasher::fold(a_extension));
+				}
+
+				BSA_NODISCARD constexpr hash_t hash(
+					stl::string_view a_stem,
+					stl::string_view a_extension,
+					std::uint32_t a_stemCRC,
+					std::uint32_t a_extCRC) const
 				{
 					constexpr std::array<std::uint32_t, 6> EXTENSIONS{
 						make_extension(""),
@@ -1208,14 +1705,9 @@ namespace bsa
 						make_extension(".adp")
 					};
 
-					auto hash = _dirHasher.hash(a_stem);
+					auto hash = _dirHasher.hash(a_stem, a_stemCRC);
 					auto& block = hash.block_ref();
-
-					std::uint32_t extCRC = 0;
-					for (auto& ch : a_extension) {
-						extCRC = ch + extCRC * dir_hasher::HASH_CONSTANT;
-					}
-					block.crc += extCRC;
+					block.crc += a_extCRC;
 
 					const auto ext = make_extension(a_extension);
 					for (std::uint8_t i = 0; i < EXTENSIONS.size(); ++i) {
@@ -1240,6 +1732,17 @@ namespace bsa
 		class file;
 		class file_iterator;
 		class hash;
+		class index_cache;
+		class vfs;
+
+		BSA_NODISCARD inline hash hash_directory(stl::string_view a_path);
+		BSA_NODISCARD inline hash hash_file(stl::string_view a_path);
+
+		namespace literals
+		{
+			BSA_NODISCARD BSA_CXX20_CONSTEVAL hash operator""_dir(const char* a_path, std::size_t a_length);
+			BSA_NODISCARD BSA_CXX20_CONSTEVAL hash operator""_file(const char* a_path, std::size_t a_length);
+		}
 
 		class hash final
 		{
@@ -1268,8 +1771,15 @@ namespace bsa
 			}
 
 		protected:
+			friend class archive;
 			friend class directory;
 			friend class file;
+			friend class index_cache;
+			friend class vfs;
+			friend hash hash_directory(stl::string_view);
+			friend hash hash_file(stl::string_view);
+			friend BSA_CXX20_CONSTEVAL hash literals::operator""_dir(const char*, std::size_t);
+			friend BSA_CXX20_CONSTEVAL hash literals::operator""_file(const char*, std::size_t);
 
 			using value_type = detail::hash_t;
 
@@ -1289,6 +1799,47 @@ namespace bsa
 
 		constexpr void swap(hash& a_lhs, hash& a_rhs) { a_lhs.swap(a_rhs); }
 
+		// hashes a directory path, i.e. "meshes\\clutter"
+		BSA_NODISCARD inline hash hash_directory(stl::string_view a_path)
+		{
+			return hash{ detail::dir_hasher()(a_path) };
+		}
+
+		// hashes a file name, i.e. "bucket01.nif"
+		BSA_NODISCARD inline hash hash_file(stl::string_view a_path)
+		{
+			return hash{ detail::file_hasher()(a_path) };
+		}
+
+		namespace detail
+		{
+			// the directory and file hashes of a full path, i.e. "meshes\\clutter\\bucket01.nif"
+			BSA_NODISCARD inline std::pair<tes4::hash, tes4::hash> hash_path(stl::string_view a_path)
+			{
+				const auto pos = a_path.find_last_of("\\/");
+				if (pos != stl::string_view::npos) {
+					return { hash_directory(a_path.substr(0, pos)), hash_file(a_path.substr(pos + 1)) };
+				} else {
+					return { hash_directory({}), hash_file(a_path) };
+				}
+			}
+		}
+
+		namespace literals
+		{
+			// hash_directory worked out at compile time, i.e. "meshes\\clutter"_dir
+			BSA_NODISCARD BSA_CXX20_CONSTEVAL hash operator""_dir(const char* a_path, std::size_t a_length)
+			{
+				return hash{ detail::dir_hasher()(detail::static_path_t{ { a_path, a_length } }) };
+			}
+
+			// hash_file worked out at compile time, i.e. "bucket01.nif"_file
+			BSA_NODISCARD BSA_CXX20_CONSTEVAL hash operator""_file(const char* a_path, std::size_t a_length)
+			{
+				return hash{ detail::file_hasher()(detail::static_path_t{ { a_path, a_length } }) };
+			}
+		}
+
 		class file final
 		{
 		public:
@@ -1310,6 +1861,25 @@ namespace bsa
 				return _impl->c_str();
 			}
 
+			BSA_NODISCARD inline bool compressed() const noexcept
+			{
+				assert(exists());
+				return _impl->compressed();
+			}
+
+			// decompresses into a_dst, which must hold at least uncompressed_size() bytes
+			inline void extract(stl::span<stl::byte> a_dst) const
+			{
+				assert(exists());
+				_impl->extract(std::move(a_dst));
+			}
+
+			inline void extract(std::ostream& a_output) const
+			{
+				assert(exists());
+				_impl->extract(a_output);
+			}
+
 			BSA_NODISCARD inline tes4::hash hash() const noexcept
 			{
 				assert(exists());
@@ -1322,7 +1892,13 @@ namespace bsa
 				return _impl->size();
 			}
 
-			BSA_NODISCARD inline const std::string& string() const noexcept
+			BSA_NODISCARD inline std::size_t uncompressed_size() const noexcept
+			{
+				assert(exists());
+				return _impl->uncompressed_size();
+			}
+
+			BSA_NODISCARD inline stl::string_view string() const noexcept
 			{
 				assert(exists());
 				return _impl->string();
@@ -1331,6 +1907,7 @@ namespace bsa
 			inline void swap(file& a_rhs) noexcept { std::swap(*this, a_rhs); }
 
 		protected:
+			friend class archive;
 			friend class file_iterator;
 
 			using value_type = detail::file_ptr;
@@ -1398,8 +1975,10 @@ namespace bsa
 
 			using iterator = typename detail::directory_t::const_iterator;
 
-			explicit inline file_iterator(iterator a_first, iterator a_last) :
+			// a_owner keeps the files alive for as long as the handles do
+			explicit inline file_iterator(detail::directory_ptr a_owner, iterator a_first, iterator a_last) :
 				_value(),
+				_owner(std::move(a_owner)),
 				_iter(std::move(a_first)),
 				_end(std::move(a_last))
 			{
@@ -1418,11 +1997,12 @@ namespace bsa
 			inline void try_set()
 			{
 				if (_iter != _end) {
-					_value = *_iter;
+					_value = detail::file_ptr(_owner, *_iter);
 				}
 			}
 
 			value_type _value;
+			detail::directory_ptr _owner;
 			iterator _iter;
 			iterator _end;
 		};
@@ -1473,7 +2053,7 @@ namespace bsa
 				return tes4::hash{ _impl->hash_ref() };
 			}
 
-			BSA_NODISCARD inline const std::string& string() const noexcept
+			BSA_NODISCARD inline stl::string_view string() const noexcept
 			{
 				assert(exists());
 				return _impl->str_ref();
@@ -1482,7 +2062,7 @@ namespace bsa
 			BSA_NODISCARD inline iterator begin() const
 			{
 				if (_impl) {
-					return iterator(_impl->begin(), _impl->end());
+					return iterator(_impl, _impl->begin(), _impl->end());
 				} else {
 					return iterator();
 				}
@@ -1491,7 +2071,7 @@ namespace bsa
 			BSA_NODISCARD inline iterator end() const
 			{
 				if (_impl) {
-					return iterator(_impl->end(), _impl->end());
+					return iterator(_impl, _impl->end(), _impl->end());
 				} else {
 					return iterator();
 				}
@@ -1605,6 +2185,23 @@ namespace bsa
 
 		inline void swap(directory_iterator& a_lhs, directory_iterator& a_rhs) noexcept { a_lhs.swap(a_rhs); }
 
+		struct extract_options final
+		{
+			std::size_t threads{ 0 };  // 0 uses one thread per core
+			bool preallocate{ true };  // reserve each file's size before writing it
+
+			// when non-zero, each thread reads, decompresses and writes its files through io_uring
+			// with up to this many requests in flight. where io_uring isn't available, the files
+			// are extracted as usual
+			std::size_t queue_depth{ 0 };
+
+			// when set, only the files for which this returns true are extracted
+			std::function<bool(const directory&, const file&)> filter;
+		};
+
+		// the const members are safe to call from any number of threads at once, data read
+		// with read_option::defer_data is decoded in place rather than resolved on access.
+		// members that modify the archive (including compress and write) need exclusive access
 		class archive final
 		{
 		public:
@@ -1615,11 +2212,25 @@ namespace bsa
 			archive(const archive&) = default;
 			archive(archive&&) noexcept = default;
 
-			inline archive(const boost::filesystem::path& a_path) :
+			// index entries are allocated from a_resource, which must outlive every directory and
+			// file handle taken from the archive
+			explicit inline archive(stl::pmr::memory_resource* a_resource) noexcept :
+				_resource(a_resource)
+			{}
+
+			inline archive(
+				const boost::filesystem::path& a_path,
+				read_option a_options = read_option::none,
+				stl::pmr::memory_resource* a_resource = nullptr) :
 				_dirs(),
-				_header()
+				_header(),
+				_dirIndex(),
+				_fileIndex(),
+				_indexGuard(),
+				_index(),
+				_resource(a_resource)
 			{
-				read(a_path);
+				read(a_path, a_options);
 			}
 
 			~archive() = default;
@@ -1662,6 +2273,219 @@ namespace bsa
 			{
 				_dirs.clear();
 				_header.clear();
+				_dirIndex.clear();
+				_fileIndex.clear();
+				_indexGuard.validate();
+				_index.reset();
+			}
+
+			// a_path is relative to the data directory, i.e. "meshes\\clutter\\bucket01.nif", and
+			// a_data is not copied, so it must outlive the archive
+			inline bool insert(const boost::filesystem::path& a_path, stl::span<const stl::byte> a_data)
+			{
+				return insert_file(a_path, std::move(a_data), stl::nullopt);
+			}
+
+			// as above, for a_data that's already compressed with the codec of version(), and
+			// decompresses to a_uncompressedSize bytes
+			inline bool insert(const boost::filesystem::path& a_path, stl::span<const stl::byte> a_data, std::size_t a_uncompressedSize)
+			{
+				return insert_file(a_path, std::move(a_data), a_uncompressedSize);
+			}
+
+			// compresses every file that isn't already, using the codec of version() and spreading
+			// the work across a_threads threads (0 picks one per core). the layout of the archive
+			// doesn't depend on the order the work finishes in, so the output is deterministic
+			inline void compress(std::size_t a_threads = 0)
+			{
+				resolve_data();
+
+				std::vector<detail::file_t*> files;
+				for (const auto& dir : _dirs) {
+					for (const auto& file : *dir) {
+						if (!file->compressed()) {
+							files.push_back(file);
+						}
+					}
+				}
+
+				// largest first, so one big file doesn't end up as the tail of the schedule
+				std::sort(
+					files.begin(),
+					files.end(),
+					[](const detail::file_t* a_lhs, const detail::file_t* a_rhs) noexcept {
+						return a_lhs->size() > a_rhs->size();
+					});
+
+				const auto ver = version();
+				detail::parallel_for(files.size(), a_threads, [&](std::size_t a_idx) {
+					files[a_idx]->compress(ver);
+				});
+
+				compressed(true);
+			}
+
+			// writes every file accepted by a_options.filter to a_root, recreating the directory
+			// structure of the archive. directory creation, decompression and writes are all
+			// spread across a_options.threads threads (0 picks one per core)
+			inline void extract(const boost::filesystem::path& a_root, const extract_options& a_options = {}) const
+			{
+				if (!boost::filesystem::exists(a_root)) {
+					throw output_error();
+				}
+
+				struct job_t
+				{
+					const detail::file_t* file;
+					std::size_t dir;
+				};
+
+				std::vector<job_t> jobs;
+				std::vector<std::size_t> dirs;
+				for (std::size_t i = 0; i < _dirs.size(); ++i) {
+					const auto& dir = _dirs[i];
+					const auto before = jobs.size();
+					for (const auto& f : *dir) {
+						if (!a_options.filter || a_options.filter(directory(dir), file(detail::file_ptr(dir, f)))) {
+							if (f->string().empty()) {
+								throw output_error("can not extract a file without a name");
+							}
+							jobs.push_back({ f, i });
+						}
+					}
+					if (jobs.size() != before) {
+						dirs.push_back(i);
+					}
+				}
+
+				std::vector<boost::filesystem::path> paths(_dirs.size());
+				detail::parallel_for(dirs.size(), a_options.threads, [&](std::size_t a_idx) {
+					const auto i = dirs[a_idx];
+					auto& path = paths[i];
+					path = detail::output_path(a_root, _dirs[i]->str_ref());
+
+					// another worker may be creating a shared parent at the same time
+					boost::system::error_code ec;
+					boost::filesystem::create_directories(path, ec);
+					if (!boost::filesystem::is_directory(path)) {
+						throw output_error("failed to create output directory");
+					}
+				});
+
+				// walk the source in the order it is laid out on disk
+				std::sort(
+					jobs.begin(),
+					jobs.end(),
+					[](const job_t& a_lhs, const job_t& a_rhs) {
+						return std::less<const stl::byte*>()(
+							a_lhs.file->get_data().data(),
+							a_rhs.file->get_data().data());
+					});
+
+				advise(detail::access_hint::sequential);
+				const auto batched =
+					a_options.queue_depth > 0 &&
+					detail::extract_files_batched(
+						_index ? _index->source() : detail::istream_t{},
+						jobs.size(),
+						a_options.threads,
+						a_options.queue_depth,
+						a_options.preallocate,
+						[&](std::size_t a_idx) {
+							const auto& job = jobs[a_idx];
+							return std::make_pair(detail::output_path(paths[job.dir], job.file->string()), job.file->get_data());
+						},
+						[&](std::size_t a_idx, stl::span<const stl::byte> a_stored, std::vector<stl::byte>& a_buffer) {
+							const auto& file = *jobs[a_idx].file;
+							if (!file.compressed()) {
+								return a_stored;
+							}
+
+							a_buffer.resize(file.uncompressed_size());
+							file.decode(a_stored, { a_buffer.data(), a_buffer.size() });
+							return stl::span<const stl::byte>{ a_buffer.data(), a_buffer.size() };
+						});
+				if (!batched) {
+					// uncompressed entries are copied straight out of the archive by the kernel
+					const detail::kernel_copier_t copier{ _index ? _index->source() : detail::istream_t{} };
+					detail::parallel_for(jobs.size(), a_options.threads, [&](std::size_t a_idx) {
+						const auto& job = jobs[a_idx];
+						const auto path = detail::output_path(paths[job.dir], job.file->string());
+						if (job.file->compressed()) {
+							thread_local std::vector<stl::byte> buffer;
+							buffer.resize(job.file->uncompressed_size());
+							job.file->extract({ buffer.data(), buffer.size() });
+							detail::write_file(path, { buffer.data(), buffer.size() }, a_options.preallocate);
+						} else {
+							copier.write_file(path, job.file->get_data(), a_options.preallocate);
+						}
+					});
+				}
+				advise(detail::access_hint::random);
+			}
+
+			// a_path is the full path of the file, i.e. "meshes\\clutter\\bucket01.nif"
+			BSA_NODISCARD inline file find(stl::string_view a_path) const
+			{
+				const auto hashes = detail::hash_path(a_path);
+				return find(hashes.first, hashes.second);
+			}
+
+			BSA_NODISCARD inline file find(const tes4::hash& a_directory, const tes4::hash& a_file) const
+			{
+				const auto it = file_index().find({ a_directory._impl.numeric(), a_file._impl.numeric() });
+				return it ? file_at(*it) : file();
+			}
+
+			// find for every pair of a_directories[i] and a_files[i], written to a_out[i]. the index
+			// is probed a group at a time, so the cache misses of a long list overlap
+			inline void find_all(
+				stl::span<const tes4::hash> a_directories,
+				stl::span<const tes4::hash> a_files,
+				stl::span<file> a_out) const
+			{
+				if (a_directories.size() != a_files.size()) {
+					throw size_error("every file needs a directory");
+				} else if (a_out.size() < a_files.size()) {
+					throw size_error("not enough room for the results");
+				}
+
+				constexpr std::size_t chunk = 256;
+				std::array<detail::hash_index_t::key_type, chunk> keys;
+				std::array<const detail::hash_index_t::mapped_type*, chunk> found;
+				for (std::size_t first = 0; first < a_files.size(); first += chunk) {
+					const auto count = (std::min)(chunk, a_files.size() - first);
+					for (std::size_t i = 0; i < count; ++i) {
+						keys[i] = { a_directories[first + i]._impl.numeric(), a_files[first + i]._impl.numeric() };
+					}
+
+					file_index().find_all({ keys.data(), count }, { found.data(), count });
+					for (std::size_t i = 0; i < count; ++i) {
+						a_out[first + i] = found[i] ? file_at(*found[i]) : file();
+					}
+				}
+			}
+
+			BSA_NODISCARD inline bool contains(stl::string_view a_path) const { return static_cast<bool>(find(a_path)); }
+
+			BSA_NODISCARD inline bool contains(const tes4::hash& a_directory, const tes4::hash& a_file) const
+			{
+				return static_cast<bool>(find(a_directory, a_file));
+			}
+
+			BSA_NODISCARD inline directory find_directory(stl::string_view a_path) const { return find_directory(hash_directory(a_path)); }
+
+			BSA_NODISCARD inline directory find_directory(const tes4::hash& a_directory) const
+			{
+				const auto it = dir_index().find({ a_directory._impl.numeric(), 0 });
+				return it ? directory(_dirs[it->first]) : directory();
+			}
+
+			BSA_NODISCARD inline bool contains_directory(stl::string_view a_path) const { return static_cast<bool>(find_directory(a_path)); }
+
+			BSA_NODISCARD inline bool contains_directory(const tes4::hash& a_directory) const
+			{
+				return static_cast<bool>(find_directory(a_directory));
 			}
 
 			BSA_NODISCARD constexpr std::size_t directory_count() const noexcept { return _header.directory_count(); }
@@ -1720,13 +2544,22 @@ namespace bsa
 			constexpr bool trees(bool a_set) noexcept { return _header.trees(a_set); }
 			constexpr bool voices(bool a_set) noexcept { return _header.voices(a_set); }
 
-			inline void read(const boost::filesystem::path& a_path)
+			inline void read(
+				const boost::filesystem::path& a_path,
+				read_option a_options = read_option::none,
+				io_backend a_backend = io_backend::mmap)
 			{
-				detail::istream_t input{ a_path };
+				if ((a_options & ~read_option::all) != read_option::none) {
+					throw input_error();
+				}
+
+				detail::istream_t input{ a_path, a_backend };
+				input.advise(detail::access_hint::sequential);
 
 				clear();
 
-				_header.read(input);
+				auto header = input.read_block(detail::header_t::block_size());
+				_header.read(header);
 				switch (version()) {
 				case v103:
 				case v104:
@@ -1736,14 +2569,26 @@ namespace bsa
 					throw version_error();
 				}
 
+				// the whole index gets parsed, so start paging it in now
+				input.advise(detail::access_hint::willneed, 0, calc_data_offset());
+
 				input.seek_beg(header_size());
+				auto block = input.read_block(detail::directory_t::block_size(version()) * directory_count());
+				_index = detail::index_t::create(_resource);
+				_index->source(input);
+				_index->reserve<detail::directory_t>(directory_count());
+				_index->reserve<detail::file_t>(file_count());
+				_dirs.reserve(directory_count());
 				for (std::size_t i = 0; i < directory_count(); ++i) {
-					const auto dir = std::make_shared<detail::directory_t>();
-					dir->read(input, _header);
+					const auto dir = detail::index_t::make<detail::directory_t>(_index);
+					dir->read(block, input, _header, _index);
 					_dirs.push_back(std::move(dir));
 				}
 
-				auto offset = directory_names_length() + directory_count();	 // include prefixed length byte
+				std::size_t offset{ 0 };
+				if (directory_strings()) {
+					offset += directory_names_length() + directory_count();	 // include prefixed length byte
+				}
 				offset += file_count() * detail::file_t::block_size();
 				input.seek_rel(offset);
 
@@ -1753,55 +2598,122 @@ namespace bsa
 					}
 				}
 
+				const auto defer = (a_options & read_option::defer_data) != read_option::none;
 				for (const auto& dir : _dirs) {
-					dir->read_file_data(input, _header);
+					if (defer) {
+						dir->defer_file_data(input, _header);
+					} else {
+						dir->read_file_data(input, _header);
+					}
 				}
 
 				sort();
-				update_all();
+				update_index();
+				if (defer) {
+					// file offsets still point at the deferred data
+					update_header();
+					update_directories();
+				} else {
+					update_all();
+				}
 				assert(check_hashes());
+
+				// from here on files are looked up one at a time
+				input.advise(detail::access_hint::random);
 			}
 
-			inline void write(const boost::filesystem::path& a_path)
+			// parses any deferred file data in a single pass over the archive,
+			// in offset order so the mapping is touched sequentially
+			inline void resolve_data()
 			{
-				std::ofstream file{ a_path.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc };
-				if (!file.is_open()) {
-					throw output_error{};
-				} else {
-					write(file);
+				std::vector<detail::file_t*> files;
+				for (const auto& dir : _dirs) {
+					for (const auto& file : *dir) {
+						if (file->deferred()) {
+							files.push_back(file);
+						}
+					}
 				}
+
+				std::sort(
+					files.begin(),
+					files.end(),
+					[](const detail::file_t* a_lhs, const detail::file_t* a_rhs) noexcept {
+						return a_lhs->offset() < a_rhs->offset();
+					});
+
+				for (auto& file : files) {
+					file->resolve_data();
+				}
+			}
+
+			inline void write(const boost::filesystem::path& a_path)
+			{
+				detail::write_file(a_path, [&](osink& a_sink) { write(a_sink); });
 			}
 
 			inline void write(std::ostream& a_output)
 			{
-				detail::ostream_t output{ a_output };
+				ostream_sink sink{ a_output };
+				write(sink);
+			}
 
-				update_all();
+			inline void write(osink& a_sink)
+			{
+				detail::ostream_t output{ a_sink };
 
-				_header.write(output);
+				resolve_data();
+				update_all();
 
+				write_index(output);
 				for (const auto& dir : _dirs) {
-					dir->write(output, _header);
+					dir->write_file_data(output, _header);
 				}
 
-				for (const auto& dir : _dirs) {
-					dir->write_extra(output, _header);
-				}
+				output.flush();
+			}
 
-				if (file_strings()) {
-					for (const auto& dir : _dirs) {
-						dir->write_file_names(output);
-					}
-				}
+			// produces the same bytes as write, but a_path is mapped at its final size up front
+			// and the file records are copied into place from a_threads threads (0 picks one per core)
+			inline void write_mapped(const boost::filesystem::path& a_path, std::size_t a_threads = 0)
+			{
+				resolve_data();
+				update_all();
 
+				std::vector<std::pair<const detail::directory_t*, const detail::file_t*>> files;
+				files.reserve(calc_file_count());
 				for (const auto& dir : _dirs) {
-					dir->write_file_data(output, _header);
+					for (const auto& file : *dir) {
+						files.emplace_back(dir.get(), file);
+					}
 				}
+
+				detail::write_mapped(a_path, size_bytes(), [&](stl::span<stl::byte> a_dst) {
+					detail::span_sink sink{ a_dst };
+					detail::ostream_t output{ sink };
+					write_index(output);
+					output.flush();
+
+					detail::parallel_for(files.size(), a_threads, [&](std::size_t a_idx) {
+						const auto dir = files[a_idx].first;
+						const auto file = files[a_idx].second;
+						const auto size = file->calc_data_size(_header, dir->name_size());
+						if (file->offset() > a_dst.size() || size > a_dst.size() - file->offset()) {
+							throw output_error();
+						}
+
+						detail::span_sink fileSink{ { a_dst.data() + file->offset(), size } };
+						detail::ostream_t fileOutput{ fileSink, 0 };
+						file->write_data(fileOutput, _header, dir->str_ref());
+					});
+				});
 			}
 
 		private:
+			friend class detail::vfs_base_t<archive>;
+			friend struct detail::index_cache_traits;
+
 			using container_t = std::vector<detail::directory_ptr>;
-			using iterator_t = typename container_t::iterator;
 
 			class directory_sorter final
 			{
@@ -1819,13 +2731,75 @@ namespace bsa
 				}
 			};
 
-			inline iterator_t binary_find(const detail::hash_t& a_hash)
+			BSA_NODISCARD inline const std::shared_ptr<detail::index_t>& index()
+			{
+				if (!_index) {
+					_index = detail::index_t::create(_resource);
+				}
+				return _index;
+			}
+
+			inline bool insert_file(
+				const boost::filesystem::path& a_path,
+				stl::span<const stl::byte> a_data,
+				stl::optional<std::size_t> a_uncompressedSize)
 			{
-				auto it = _dirs.begin();
-				const auto itEnd = _dirs.end();
-				it = std::lower_bound(it, itEnd, a_hash, directory_sorter());
+				const detail::path_t path{ a_path };
+				const auto fullPath = path.string_view();
+				const auto pos = fullPath.find_last_of('\\');
+
+				std::string dirName{ "." };
+				std::string fileName{ fullPath.data(), fullPath.size() };
+				if (pos != stl::string_view::npos) {
+					dirName.assign(fullPath.data(), pos);
+					fileName.assign(fullPath.data() + pos + 1, fullPath.size() - pos - 1);
+				}
+
+				if (fileName.empty()) {
+					throw hash_empty();
+				}
+
+				const auto dHash = detail::dir_hasher()(dirName);
+				const auto fHash = detail::file_hasher()(fileName);
 
-				return it != _dirs.end() && (*it)->hash_ref() == a_hash ? it : itEnd;
+				auto it = std::lower_bound(_dirs.begin(), _dirs.end(), dHash, directory_sorter());
+				if (it == _dirs.end() || (*it)->hash_ref() != dHash) {
+					it = _dirs.insert(it, detail::index_t::make<detail::directory_t>(index(), std::move(dirName), dHash));
+					_header.directory_count(directory_count() + 1);
+					_header.directory_names_length(directory_names_length() + (*it)->name_size());
+				}
+
+				const auto file = index()->construct<detail::file_t>(std::move(fileName), fHash, version());
+				file->set_data(std::move(a_data), a_uncompressedSize);
+				if (!(*it)->insert(file)) {
+					return false;
+				}
+
+				// the header is kept current, but the lookup tables are only rebuilt once they're
+				// next searched, so a run of inserts costs one rebuild rather than one each
+				_header.file_count(file_count() + 1);
+				_header.file_names_length(file_names_length() + file->name_size());
+				_indexGuard.invalidate();
+				return true;
+			}
+
+			BSA_NODISCARD inline const detail::hash_index_t& dir_index() const
+			{
+				_indexGuard.refresh([&]() { update_index(); });
+				return _dirIndex;
+			}
+
+			BSA_NODISCARD inline const detail::hash_index_t& file_index() const
+			{
+				_indexGuard.refresh([&]() { update_index(); });
+				return _fileIndex;
+			}
+
+			// the file an index entry points at
+			BSA_NODISCARD inline file file_at(const detail::hash_index_t::mapped_type& a_entry) const noexcept
+			{
+				const auto& dir = _dirs[a_entry.first];
+				return file(detail::file_ptr(dir, *(dir->begin() + a_entry.second)));
 			}
 
 			BSA_NODISCARD inline std::size_t calc_data_offset() const
@@ -1880,13 +2854,20 @@ namespace bsa
 				return length;
 			}
 
+			// names the archive didn't store read back empty, so there's nothing to check them by
 			inline bool check_hashes()
 			{
 				detail::hash_t dHash;
 				for (const auto& dir : _dirs) {
-					dHash = detail::dir_hasher()(dir->str_ref());
-					if (dHash != dir->hash()) {
-						return false;
+					if (directory_strings()) {
+						dHash = detail::dir_hasher()(dir->str_ref());
+						if (dHash != dir->hash()) {
+							return false;
+						}
+					}
+
+					if (!file_strings()) {
+						continue;
 					}
 
 					for (const auto& file : *dir) {
@@ -1912,6 +2893,33 @@ namespace bsa
 				}
 			}
 
+			inline void advise(detail::access_hint a_hint) const noexcept
+			{
+				if (_index) {
+					_index->source().advise(a_hint);
+				}
+			}
+
+			// everything up to the file data
+			inline void write_index(detail::ostream_t& a_output) const
+			{
+				_header.write(a_output);
+
+				for (const auto& dir : _dirs) {
+					dir->write(a_output, _header);
+				}
+
+				for (const auto& dir : _dirs) {
+					dir->write_extra(a_output, _header);
+				}
+
+				if (file_strings()) {
+					for (const auto& dir : _dirs) {
+						dir->write_file_names(a_output);
+					}
+				}
+			}
+
 			inline void update_all()
 			{
 				update_header();
@@ -1922,7 +2930,9 @@ namespace bsa
 			inline void update_directories()
 			{
 				std::size_t offset{ 0 };
-				offset += file_names_length();
+				if (file_strings()) {  // the header only counts the names it stores
+					offset += file_names_length();
+				}
 				offset += detail::header_t::block_size();
 				offset += detail::directory_t::block_size(version()) * directory_count();
 
@@ -1946,6 +2956,25 @@ namespace bsa
 				}
 			}
 
+			inline void update_index() const
+			{
+				_dirIndex.clear();
+				_fileIndex.clear();
+				_dirIndex.reserve(_dirs.size());
+				_fileIndex.reserve(calc_file_count());
+
+				for (std::size_t i = 0; i < _dirs.size(); ++i) {
+					const auto& dir = _dirs[i];
+					const auto dHash = dir->hash_ref().numeric();
+					_dirIndex.insert({ dHash, 0 }, { i, 0 });
+
+					std::size_t j = 0;
+					for (const auto& file : *dir) {
+						_fileIndex.insert({ dHash, file->hash_ref().numeric() }, { i, j++ });
+					}
+				}
+			}
+
 			inline void update_header()
 			{
 				_header.directory_count(
@@ -1961,6 +2990,116 @@ namespace bsa
 
 			container_t _dirs;
 			detail::header_t _header;
+			mutable detail::hash_index_t _dirIndex;
+			mutable detail::hash_index_t _fileIndex;
+			detail::stale_guard_t _indexGuard;
+			std::shared_ptr<detail::index_t> _index;
+			stl::pmr::memory_resource* _resource{ nullptr };
+		};
+
+		// files are found by their directory and file hashes. see detail::vfs_base_t
+		class vfs final :
+			public detail::vfs_base_t<archive>
+		{
+		public:
+			// a_path as for archive::find
+			BSA_NODISCARD inline file find(stl::string_view a_path) const
+			{
+				const auto hashes = detail::hash_path(a_path);
+				return find(hashes.first, hashes.second);
+			}
+
+			// the archive may build its lookup tables on first use, so this can throw
+			BSA_NODISCARD inline file find(const hash& a_directory, const hash& a_file) const
+			{
+				const auto archive = find_archive(a_directory, a_file);
+				return archive ? archive->find(a_directory, a_file) : file();
+			}
+
+			// the archive that wins the file, or nullptr if none of them have it
+			BSA_NODISCARD inline const archive* find_archive(const hash& a_directory, const hash& a_file) const noexcept
+			{
+				return find_key({ a_directory._impl.numeric(), a_file._impl.numeric() });
+			}
+
+			BSA_NODISCARD inline bool contains(stl::string_view a_path) const { return static_cast<bool>(find(a_path)); }
+
+			BSA_NODISCARD inline bool contains(const hash& a_directory, const hash& a_file) const noexcept
+			{
+				return find_archive(a_directory, a_file) != nullptr;
+			}
+
+			// decompresses the winning copy of a_path into a_out, which is reused between calls.
+			// returns false if no archive has it
+			inline bool read(stl::string_view a_path, std::vector<stl::byte>& a_out) const
+			{
+				const auto f = find(a_path);
+				if (!f) {
+					return false;
+				}
+
+				a_out.resize(f.uncompressed_size());
+				f.extract({ a_out.data(), a_out.size() });
+				return true;
+			}
+		};
+
+		namespace detail
+		{
+			// how index_cache reads and records tes4 archives
+			struct index_cache_traits final
+			{
+				using archive_type = archive;
+
+				BSA_NODISCARD static constexpr cache_format format() noexcept { return cache_format::tes4; }
+
+				BSA_NODISCARD static inline archive read(const boost::filesystem::path& a_path)
+				{
+					return archive{ a_path, read_option::defer_data };
+				}
+
+				static inline void add(index_cache_writer_t& a_writer, const archive& a_source)
+				{
+					if (!a_source._index) {
+						throw input_error();
+					}
+
+					const auto& input = a_source._index->source();
+					a_writer.reserve(a_source.file_count());
+					for (const auto& dir : a_source._dirs) {
+						const auto dHash = dir->hash_ref().numeric();
+						for (const auto& file : *dir) {
+							a_writer.add(
+								{ dHash, file->hash_ref().numeric() },
+								file->data_offset(input),
+								file->size(),
+								file->uncompressed_size(),
+								file->compressed(),
+								dir->str_ref(),
+								file->string());
+						}
+					}
+				}
+			};
+		}
+
+		// files are keyed by their directory and file hashes, as in the archive. see
+		// detail::index_cache_base_t
+		class index_cache final :
+			public detail::index_cache_base_t<detail::index_cache_traits>
+		{
+		public:
+			// a_path as for archive::find
+			BSA_NODISCARD inline cached_file find(stl::string_view a_path) const
+			{
+				const auto hashes = detail::hash_path(a_path);
+				return find(hashes.first, hashes.second);
+			}
+
+			BSA_NODISCARD inline cached_file find(const hash& a_directory, const hash& a_file) const noexcept
+			{
+				return find_key({ a_directory._impl.numeric(), a_file._impl.numeric() });
+			}
 		};
 
 		inline archive& operator<<(archive& a_archive, const boost::filesystem::path& a_path)
@@ -1980,5 +3119,11 @@ namespace bsa
 			a_archive.write(a_stream);
 			return a_archive;
 		}
+
+		inline archive& operator>>(archive& a_archive, osink& a_sink)
+		{
+			a_archive.write(a_sink);
+			return a_archive;
+		}
 	}
 }
@@ -1,14 +1,22 @@
 #define BSA_PRESERVE_PADDING
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <numeric>
+#include <random>
 #include <sstream>
 #include <streambuf>
+#include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -17,8 +25,9 @@
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/regex.hpp>
 
+#include <zlib.h>
+
 #include "bsa/bsa.hpp"
-#include "mstream.hpp"
 
 namespace filesystem = boost::filesystem;
 
@@ -89,7 +98,7 @@ private:
 	std::chrono::time_point<clock_t> _start;
 };
 
-void compare_files(const boost::iostreams::mapped_file_source& a_lhs, nonstd::span<const char> a_rhs)
+void compare_files(const boost::iostreams::mapped_file_source& a_lhs, bsa::stl::span<const std::byte> a_rhs)
 {
 	if (a_lhs.size() != a_rhs.size()) {
 		util::print(color::red, "FAIL (size: ", a_lhs.size(), " != size: ", a_rhs.size(), ')');
@@ -98,7 +107,7 @@ void compare_files(const boost::iostreams::mapped_file_source& a_lhs, nonstd::sp
 
 	if (std::memcmp(a_lhs.data(), a_rhs.data(), a_rhs.size()) != 0) {
 		for (std::size_t i = 0; i < a_rhs.size(); ++i) {
-			if (a_lhs.data()[i] != a_rhs.data()[i]) {
+			if (static_cast<std::byte>(a_lhs.data()[i]) != a_rhs.data()[i]) {
 				util::print(color::red, "FAIL (at pos ", i, ')');
 				return;
 			}
@@ -109,7 +118,7 @@ void compare_files(const boost::iostreams::mapped_file_source& a_lhs, nonstd::sp
 }
 
 template <class Archive>
-void write_archives(nonstd::span<const filesystem::path> a_directories)
+void write_archives(bsa::stl::span<const filesystem::path> a_directories)
 {
 	boost::regex regex{ ".*\\.bsa$", boost::regex_constants::grep | boost::regex_constants::icase };
 	Archive archive;
@@ -122,11 +131,11 @@ void write_archives(nonstd::span<const filesystem::path> a_directories)
 					boost::iostreams::mapped_file_source src{ path };
 					archive << path;
 
-					omemorystream os(archive.size_bytes());
-					archive >> os;
+					bsa::memory_sink sink{ archive.size_bytes() };
+					archive >> sink;
 
 					std::cout << path << ' ';
-					compare_files(src, os.span());
+					compare_files(src, sink.span());
 					std::cout << std::endl;
 				}
 			}
@@ -134,7 +143,7 @@ void write_archives(nonstd::span<const filesystem::path> a_directories)
 	}
 }
 
-void parse_archives(nonstd::span<const filesystem::path> a_directories, std::function<void(const filesystem::path&)> a_functor)
+void parse_archives(bsa::stl::span<const filesystem::path> a_directories, std::function<void(const filesystem::path&)> a_functor)
 {
 	boost::regex regex{ ".*\\.bsa$", boost::regex_constants::grep | boost::regex_constants::icase };
 
@@ -160,7 +169,7 @@ public:
 			for (auto& file : archive) {
 				if (!archive.contains(file)) {
 					assert(false);
-				} else if (!archive.find(file.string())) {
+				} else if (!archive.find(std::string(file.string()))) {
 					assert(false);
 				}
 				std::cout << file.string() << '\n';
@@ -196,10 +205,90 @@ public:
 		filesystem::path path{ "E:\\Games\\SteamLibrary\\steamapps\\common\\Morrowind\\Data Files\\Tribunal.bsa" };
 		boost::iostreams::mapped_file_source src{ path };
 
-		omemorystream os(archive.size_bytes());
-		archive >> os;
+		bsa::memory_sink sink{ archive.size_bytes() };
+		archive >> sink;
 
-		compare_files(src, os.span());
+		compare_files(src, sink.span());
+	}
+
+	// files packed from a path on disk have to keep their size through a write and read back
+	static void pack_path()
+	{
+		const auto src = filesystem::temp_directory_path() / "bsa_pack_path.bin";
+		const auto path = filesystem::temp_directory_path() / "bsa_pack_path.bsa";
+		std::vector<std::byte> data(100);
+		for (std::size_t i = 0; i < data.size(); ++i) {
+			data[i] = static_cast<std::byte>(i);
+		}
+		{
+			std::ofstream file{ src.string(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc };
+			file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		}
+
+		archive_type archive;
+		file_type packed{ "meshes\\a.nif", src };
+		archive.insert(packed);
+		archive.write(path);
+
+		const archive_type read{ path };
+		const auto file = read.find("meshes\\a.nif");
+		const auto passed = packed.size() == data.size() && file && file.size() == data.size();
+
+		std::cout << "pack from path ";
+		if (passed) {
+			compare_files(boost::iostreams::mapped_file_source{ src }, file.extract());
+		} else {
+			util::print(color::red, "FAIL (size: ", packed.size(), ')');
+		}
+		std::cout << std::endl;
+
+		filesystem::remove(path);
+		filesystem::remove(src);
+	}
+
+	// lookups through the eytzinger index, one find per hash against a single find_all
+	static void bench_find()
+	{
+		constexpr std::size_t fileCount = 1u << 16;
+		constexpr std::size_t rounds = 16;
+
+		const std::array<std::byte, 1> data{};
+		std::vector<file_type> files;
+		files.reserve(fileCount);
+		for (std::size_t i = 0; i < fileCount; ++i) {
+			files.emplace_back("meshes\\bench" + std::to_string(i % 64) + "\\file" + std::to_string(i) + ".nif", bsa::stl::span<const std::byte>{ data.data(), data.size() });
+		}
+
+		archive_type archive;
+		archive.insert(files.begin(), files.end());
+
+		std::vector<bsa::tes3::hash> hashes;
+		for (const auto& file : files) {
+			hashes.push_back(file.hash());
+		}
+		std::shuffle(hashes.begin(), hashes.end(), std::mt19937{ 0 });
+
+		std::vector<file_type> scalar(hashes.size());
+		std::vector<file_type> batch(hashes.size());
+		const auto time = [&](auto&& a_func) {
+			const auto start = std::chrono::steady_clock::now();
+			for (std::size_t i = 0; i < rounds; ++i) {
+				a_func();
+			}
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			return elapsed.count() * 1e9 / (rounds * hashes.size());
+		};
+
+		const auto scalarTime = time([&]() {
+			for (std::size_t i = 0; i < hashes.size(); ++i) {
+				scalar[i] = archive.find(hashes[i]);
+			}
+		});
+		const auto batchTime = time([&]() { archive.find_all(hashes, batch); });
+		const auto matching = std::equal(scalar.begin(), scalar.end(), batch.begin(), [](const auto& a_lhs, const auto& a_rhs) {
+			return a_lhs && a_rhs && a_lhs.hash().numeric() == a_rhs.hash().numeric();
+		});
+		std::cout << "find: " << hashes.size() << " lookups, " << scalarTime << "ns scalar, " << batchTime << "ns batched, " << (matching ? "matching" : "MISMATCHED") << "\n";
 	}
 
 private:
@@ -241,9 +330,553 @@ public:
 		write_archives<archive_type>({ PATHS });
 	}
 
+	// single core lz4 decompression throughput on a synthetic sse archive
+	static void bench_lz4()
+	{
+		constexpr std::size_t dirCount = 8;
+		constexpr std::size_t fileCount = 32;
+		constexpr std::size_t fileSize = 1u << 20;
+
+		const auto path = filesystem::temp_directory_path() / "bsa_bench_lz4.bsa";
+		make_sse_archive(path, dirCount, fileCount, fileSize);
+
+		archive_type archive{ path };
+		std::vector<std::byte> buffer(fileSize);
+		std::size_t total = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+		for (const auto& dir : archive) {
+			for (const auto& file : dir) {
+				file.extract({ buffer.data(), file.uncompressed_size() });
+				total += file.uncompressed_size();
+			}
+		}
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::cout << "lz4: " << total << " bytes in " << elapsed.count() << "s, " << (total / elapsed.count() / 1e9) << " GB/s\n";
+		filesystem::remove(path);
+	}
+
+	// archive-level extraction throughput, single threaded vs one thread per core
+	static void bench_extract()
+	{
+		constexpr std::size_t dirCount = 16;
+		constexpr std::size_t fileCount = 64;
+		constexpr std::size_t fileSize = 1u << 18;
+
+		const auto path = filesystem::temp_directory_path() / "bsa_bench_extract.bsa";
+		const auto root = filesystem::temp_directory_path() / "bsa_bench_extract";
+		make_sse_archive(path, dirCount, fileCount, fileSize);
+
+		archive_type archive{ path };
+		const auto total = dirCount * fileCount * fileSize;
+		// { threads, io_uring queue depth }
+		const std::array<std::pair<std::size_t, std::size_t>, 4> configs{ {
+			{ 1, 0 },
+			{ 0, 0 },
+			{ 1, 32 },
+			{ 2, 32 },
+		} };
+		for (const auto& [threads, depth] : configs) {
+			filesystem::remove_all(root);
+			filesystem::create_directories(root);
+
+			bsa::tes4::extract_options options;
+			options.threads = threads;
+			options.queue_depth = depth;
+
+			const auto start = std::chrono::steady_clock::now();
+			archive.extract(root, options);
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			std::cout << "extract (" << (threads == 0 ? "all" : std::to_string(threads)) << " threads, queue depth " << depth << "): " << total << " bytes in " << elapsed.count() << "s, " << (total / elapsed.count() / 1e9) << " GB/s\n";
+		}
+
+		filesystem::remove_all(root);
+		filesystem::remove(path);
+	}
+
+	// repack throughput of the streamed writer vs the mapped one, which must match it byte for byte
+	static void bench_write()
+	{
+		constexpr std::size_t dirCount = 16;
+		constexpr std::size_t fileCount = 64;
+		constexpr std::size_t fileSize = 1u << 18;
+
+		const auto src = filesystem::temp_directory_path() / "bsa_bench_write.bsa";
+		const auto streamed = filesystem::temp_directory_path() / "bsa_bench_write_streamed.bsa";
+		const auto mapped = filesystem::temp_directory_path() / "bsa_bench_write_mapped.bsa";
+		make_sse_archive(src, dirCount, fileCount, fileSize);
+
+		archive_type archive{ src };
+		const auto total = archive.size_bytes();
+		const auto time = [&](auto&& a_func) {
+			const auto start = std::chrono::steady_clock::now();
+			a_func();
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			return elapsed.count();
+		};
+
+		const auto streamedTime = time([&]() { archive.write(streamed); });
+		const auto mappedTime = time([&]() { archive.write_mapped(mapped); });
+		std::cout << "write (streamed): " << total << " bytes in " << streamedTime << "s, " << (total / streamedTime / 1e9) << " GB/s\n";
+		std::cout << "write (mapped): " << total << " bytes in " << mappedTime << "s, " << (total / mappedTime / 1e9) << " GB/s\n";
+
+		{
+			boost::iostreams::mapped_file_source lhs{ streamed };
+			boost::iostreams::mapped_file_source rhs{ mapped };
+			std::cout << "mapped output ";
+			compare_files(lhs, { reinterpret_cast<const std::byte*>(rhs.data()), rhs.size() });
+			std::cout << std::endl;
+		}
+
+		filesystem::remove(mapped);
+		filesystem::remove(streamed);
+		filesystem::remove(src);
+	}
+
+	// hashes worked out at compile time have to match the ones hashed at runtime
+	static void literals()
+	{
+		using namespace bsa::tes4::literals;
+
+		constexpr auto dir = "Meshes/Clutter/"_dir;
+		constexpr auto file = "Bucket01.NIF"_file;
+		std::cout << "directory literal " << (dir.numeric() == bsa::tes4::hash_directory("Meshes/Clutter/").numeric() ? "matching" : "MISMATCHED") << '\n';
+		std::cout << "file literal " << (file.numeric() == bsa::tes4::hash_file("Bucket01.NIF").numeric() ? "matching" : "MISMATCHED") << '\n';
+	}
+
+	// a load order of archives that all hold the same files, resolved through the vfs against
+	// a search of every archive from the last one down
+	static void load_order()
+	{
+		constexpr std::size_t archiveCount = 64;
+		constexpr std::size_t dirCount = 16;
+		constexpr std::size_t fileCount = 64;
+
+		std::vector<filesystem::path> paths;
+		for (std::size_t i = 0; i < archiveCount; ++i) {
+			paths.push_back(filesystem::temp_directory_path() / ("bsa_load_order" + std::to_string(i) + ".bsa"));
+			make_sse_archive(paths.back(), dirCount, fileCount, 16);
+		}
+
+		bsa::tes4::vfs vfs;
+		const auto start = std::chrono::steady_clock::now();
+		for (const auto& path : paths) {
+			vfs.push_back(path);
+		}
+		const std::chrono::duration<double> loaded = std::chrono::steady_clock::now() - start;
+
+		// every other name is missing, which is the worst case for a search of every archive
+		std::vector<std::string> names;
+		for (const auto& dir : *vfs[0]) {
+			for (const auto& file : dir) {
+				names.push_back(std::string(dir.string()) + '\\' + std::string(file.string()));
+				names.push_back(std::string(dir.string()) + "\\missing" + std::string(file.string()));
+			}
+		}
+
+		const auto time = [&](auto&& a_find) {
+			std::size_t found = 0;
+			const auto begin = std::chrono::steady_clock::now();
+			for (const auto& name : names) {
+				found += a_find(name) ? 1 : 0;
+			}
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+			return std::make_pair(elapsed.count() * 1e9 / names.size(), found);
+		};
+
+		const auto merged = time([&](const std::string& a_name) { return vfs.find(a_name); });
+		const auto scanned = time([&](const std::string& a_name) {
+			for (auto i = vfs.size(); i-- > 0;) {
+				if (auto file = vfs[i]->find(a_name); file) {
+					return file;
+				}
+			}
+			return bsa::tes4::file();
+		});
+
+		// the last archive wins, and erasing it hands every file to the one below
+		const auto dir = bsa::tes4::hash_directory("textures\\bench0");
+		const auto file = bsa::tes4::hash_file("file0.dds");
+		const auto winner = vfs.find_archive(dir, file) == vfs[vfs.size() - 1].get();
+		vfs.erase(vfs.size() - 1);
+		const auto fallback = vfs.find_archive(dir, file) == vfs[vfs.size() - 1].get();
+		const auto passed =
+			merged.second == names.size() / 2 && scanned.second == names.size() / 2 &&
+			winner && fallback;
+
+		std::cout << "load order: " << archiveCount << " archives loaded in " << loaded.count() << "s, " << merged.first << "ns merged, " << scanned.first << "ns scanned ";
+		if (passed) {
+			util::print(color::green, "PASS");
+		} else {
+			util::print(color::red, "FAIL");
+		}
+		std::cout << std::endl;
+
+		for (const auto& path : paths) {
+			filesystem::remove(path);
+		}
+	}
+
+	// opening a cached index against parsing the archive it was written from, then finding
+	// every file through both
+	static void index_cache()
+	{
+		constexpr std::size_t iterations = 32;
+
+		const auto path = filesystem::temp_directory_path() / "bsa_index_cache.bsa";
+		const auto cachePath = filesystem::temp_directory_path() / "bsa_index_cache.idx";
+		make_sse_archive(path, 64, 256, 16);
+		filesystem::remove(cachePath);
+
+		bsa::tes4::index_cache cache;
+		cache.open_or_build(cachePath, path);
+		cache.close();
+
+		auto begin = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < iterations; ++i) {
+			bsa::tes4::archive archive{ path, bsa::tes4::read_option::defer_data };
+		}
+		const std::chrono::duration<double> parsed = std::chrono::steady_clock::now() - begin;
+
+		begin = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < iterations; ++i) {
+			cache.close();
+			cache.open(cachePath, path);
+		}
+		const std::chrono::duration<double> opened = std::chrono::steady_clock::now() - begin;
+
+		const bsa::tes4::archive archive{ path };
+		std::vector<std::string> names;
+		for (const auto& dir : archive) {
+			for (const auto& file : dir) {
+				names.push_back(std::string(dir.string()) + '\\' + std::string(file.string()));
+			}
+		}
+
+		std::size_t hits = 0;
+		begin = std::chrono::steady_clock::now();
+		for (const auto& name : names) {
+			hits += cache.find(name) ? 1 : 0;
+		}
+		const std::chrono::duration<double> found = std::chrono::steady_clock::now() - begin;
+
+		auto passed = cache.size() == names.size() && hits == names.size();
+		for (const auto& name : names) {
+			const auto cached = cache.find(name);
+			passed = passed && cached.string() == name && cached.size() == archive.find(name).size();
+		}
+
+		// rewritten at the same size, well within the second the cache was written in
+		cache.close();
+		make_sse_archive(path, 64, 256, 16);
+		passed = passed && !cache.open(cachePath, path);
+
+		std::cout << "index cache: " << names.size() << " files, " << parsed.count() * 1e6 / iterations << "us parsed, " << opened.count() * 1e6 / iterations << "us opened, " << found.count() * 1e9 / names.size() << "ns per find ";
+		if (passed) {
+			util::print(color::green, "PASS");
+		} else {
+			util::print(color::red, "FAIL");
+		}
+		std::cout << std::endl;
+
+		cache.close();
+		filesystem::remove(cachePath);
+		filesystem::remove(path);
+	}
+
+	// names that step outside the extraction root have to be refused before anything is written
+	static void hostile_paths()
+	{
+		const std::array<const char*, 3> names{ "..\\..\\slipped\\evil.txt", "meshes\\..\\..\\evil.txt", "c:\\slipped\\evil.txt" };
+		const auto path = filesystem::temp_directory_path() / "bsa_hostile.bsa";
+		const auto base = filesystem::temp_directory_path() / "bsa_hostile";
+		const auto root = base / "a" / "b";
+		const std::array<std::byte, 4> data{};
+
+		for (const auto& name : names) {
+			filesystem::remove_all(base);
+			filesystem::create_directories(root);
+
+			archive_type archive;
+			archive.version(bsa::tes4::v104);
+			archive.directory_strings(true);
+			archive.file_strings(true);
+			archive.insert(name, { data.data(), data.size() });
+			archive.write(path);
+
+			auto rejected = false;
+			try {
+				archive_type{ path }.extract(root);
+			} catch (const bsa::output_error&) {
+				rejected = true;
+			}
+
+			std::size_t written = 0;
+			for (const auto& entry : filesystem::recursive_directory_iterator(base)) {
+				written += filesystem::is_regular_file(entry) ? 1 : 0;
+			}
+
+			std::cout << "hostile path " << name << ' ';
+			if (rejected && written == 0) {
+				util::print(color::green, "PASS");
+			} else {
+				util::print(color::red, "FAIL");
+			}
+			std::cout << std::endl;
+		}
+
+		filesystem::remove_all(base);
+		filesystem::remove(path);
+	}
+
+	// archives written without names have to read back as empty strings, not null ones, and
+	// any names they do store have to be found where the header says
+	static void no_strings()
+	{
+		const auto path = filesystem::temp_directory_path() / "bsa_no_strings.bsa";
+		const std::array<std::byte, 4> data{ std::byte{ 1 }, std::byte{ 2 }, std::byte{ 3 }, std::byte{ 4 } };
+
+		for (const auto version : { bsa::tes4::v103, bsa::tes4::v104, bsa::tes4::v105 }) {
+			for (const auto fileStrings : { false, true }) {
+				{
+					archive_type archive;
+					archive.version(version);
+					archive.directory_strings(false);
+					archive.file_strings(fileStrings);
+					archive.insert("meshes\\clutter\\bucket01.nif", { data.data(), data.size() });
+					archive.write(path);
+				}
+
+				const archive_type archive{ path };
+				const bsa::stl::string_view expected = fileStrings ? "bucket01.nif" : "";
+				std::size_t files = 0;
+				auto passed = true;
+				for (const auto& dir : archive) {
+					passed = passed && dir.c_str() != nullptr && std::strlen(dir.c_str()) == 0;
+					for (const auto& file : dir) {
+						std::array<std::byte, 4> extracted{};
+						file.extract({ extracted.data(), extracted.size() });
+						passed = passed && file.c_str() != nullptr && file.c_str() == expected && extracted == data;
+						++files;
+					}
+				}
+
+				std::cout << "no strings v" << version << (fileStrings ? " (file strings) " : " ");
+				if (passed && files == 1) {
+					util::print(color::green, "PASS");
+				} else {
+					util::print(color::red, "FAIL");
+				}
+				std::cout << std::endl;
+			}
+		}
+
+		filesystem::remove(path);
+	}
+
+	// data compressed by the caller has to keep the size it decompresses to
+	static void precompressed()
+	{
+		const auto path = filesystem::temp_directory_path() / "bsa_precompressed.bsa";
+		std::vector<std::byte> original(1u << 16);
+		for (std::size_t i = 0; i < original.size(); ++i) {
+			original[i] = static_cast<std::byte>(i % 251);
+		}
+
+		auto length = compressBound(static_cast<uLong>(original.size()));
+		std::vector<std::byte> compressed(length);
+		const auto result = compress2(
+			reinterpret_cast<Bytef*>(compressed.data()),
+			&length,
+			reinterpret_cast<const Bytef*>(original.data()),
+			static_cast<uLong>(original.size()),
+			Z_BEST_COMPRESSION);
+		compressed.resize(length);
+
+		{
+			archive_type archive;
+			archive.version(bsa::tes4::v104);
+			archive.directory_strings(true);
+			archive.file_strings(true);
+			archive.insert("meshes\\precompressed.nif", { compressed.data(), compressed.size() }, original.size());
+			archive.write(path);
+		}
+
+		const archive_type archive{ path };
+		const auto file = archive.find("meshes\\precompressed.nif");
+		auto passed = result == Z_OK && file && file.compressed() && file.uncompressed_size() == original.size();
+		if (passed) {
+			std::vector<std::byte> extracted(file.uncompressed_size());
+			file.extract({ extracted.data(), extracted.size() });
+			passed = extracted == original;
+		}
+
+		std::cout << "precompressed ";
+		if (passed) {
+			util::print(color::green, "PASS");
+		} else {
+			util::print(color::red, "FAIL");
+		}
+		std::cout << std::endl;
+
+		filesystem::remove(path);
+	}
+
+	// one shared archive, with every thread finding and extracting every file
+	static void concurrent()
+	{
+		constexpr std::size_t dirCount = 8;
+		constexpr std::size_t fileCount = 32;
+		constexpr std::size_t fileSize = 1u << 16;
+
+		const auto path = filesystem::temp_directory_path() / "bsa_concurrent.bsa";
+		make_sse_archive(path, dirCount, fileCount, fileSize);
+
+		const archive_type archive{ path };
+		std::vector<std::string> names;
+		std::vector<std::vector<std::byte>> expected;
+		for (const auto& dir : archive) {
+			for (const auto& file : dir) {
+				names.push_back(std::string(dir.string()) + '\\' + std::string(file.string()));
+				auto& data = expected.emplace_back(file.uncompressed_size());
+				file.extract({ data.data(), data.size() });
+			}
+		}
+
+		std::atomic_size_t failures{ 0 };
+		std::vector<std::thread> workers;
+		const auto threads = std::max(std::thread::hardware_concurrency(), 2u);
+		for (std::size_t i = 0; i < threads; ++i) {
+			workers.emplace_back([&, i]() {
+				std::vector<std::byte> buffer;
+				for (std::size_t j = 0; j < names.size(); ++j) {
+					const auto idx = (i * 7 + j) % names.size();  // stagger the threads
+					const auto file = archive.find(names[idx]);
+					if (!file) {
+						++failures;
+						continue;
+					}
+
+					buffer.resize(file.uncompressed_size());
+					file.extract({ buffer.data(), buffer.size() });
+					if (buffer != expected[idx]) {
+						++failures;
+					}
+				}
+			});
+		}
+
+		for (auto& worker : workers) {
+			worker.join();
+		}
+
+		std::cout << "concurrent (" << threads << " threads) ";
+		if (failures == 0) {
+			util::print(color::green, "PASS");
+		} else {
+			util::print(color::red, "FAIL (", failures.load(), " mismatches)");
+		}
+		std::cout << std::endl;
+
+		filesystem::remove(path);
+	}
+
+	// one find per lookup against a single batched find_all, half of the lookups missing
+	static void bench_find()
+	{
+		constexpr std::size_t dirCount = 256;
+		constexpr std::size_t fileCount = 256;
+		constexpr std::size_t rounds = 16;
+
+		const auto path = filesystem::temp_directory_path() / "bsa_find.bsa";
+		make_sse_archive(path, dirCount, fileCount, 16);
+
+		const archive_type archive{ path };
+		std::vector<bsa::tes4::hash> dirs;
+		std::vector<bsa::tes4::hash> files;
+		for (const auto& dir : archive) {
+			for (const auto& file : dir) {
+				dirs.push_back(dir.hash());
+				files.push_back(file.hash());
+				dirs.push_back(dir.hash());
+				files.push_back(bsa::tes4::hash_file("missing" + std::to_string(files.size()) + ".dds"));
+			}
+		}
+
+		std::mt19937 rng{ 0 };
+		std::vector<std::size_t> order(files.size());
+		std::iota(order.begin(), order.end(), std::size_t{ 0 });
+		std::shuffle(order.begin(), order.end(), rng);
+		for (std::size_t i = 0; i < order.size(); ++i) {
+			std::swap(dirs[i], dirs[order[i]]);
+			std::swap(files[i], files[order[i]]);
+		}
+
+		std::vector<bsa::tes4::file> scalar(files.size());
+		std::vector<bsa::tes4::file> batch(files.size());
+		const auto time = [&](auto&& a_func) {
+			const auto start = std::chrono::steady_clock::now();
+			for (std::size_t i = 0; i < rounds; ++i) {
+				a_func();
+			}
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			return elapsed.count() * 1e9 / (rounds * files.size());
+		};
+
+		const auto scalarTime = time([&]() {
+			for (std::size_t i = 0; i < files.size(); ++i) {
+				scalar[i] = archive.find(dirs[i], files[i]);
+			}
+		});
+		const auto batchTime = time([&]() { archive.find_all(dirs, files, batch); });
+		const auto matching = std::equal(scalar.begin(), scalar.end(), batch.begin(), [](const auto& a_lhs, const auto& a_rhs) {
+			return static_cast<bool>(a_lhs) == static_cast<bool>(a_rhs) &&
+				   (!a_lhs || a_lhs.hash().numeric() == a_rhs.hash().numeric());
+		});
+		std::cout << "find: " << files.size() << " lookups, " << scalarTime << "ns scalar, " << batchTime << "ns batched, " << (matching ? "matching" : "MISMATCHED") << "\n";
+
+		filesystem::remove(path);
+	}
+
 private:
 	using archive_type = bsa::tes4::archive;
 
+	// writes a v105 archive of compressed files
+	static void make_sse_archive(const filesystem::path& a_path, std::size_t a_dirCount, std::size_t a_fileCount, std::size_t a_fileSize)
+	{
+		// text-like, so the compression ratio is in the same ballpark as real assets
+		constexpr std::array WORDS{ "mesh ", "texture ", "normal ", "alpha ", "specular ", "glow ", "parallax ", "cube " };
+		std::mt19937 rng{ 0 };
+		std::string plain;
+		while (plain.size() < a_fileSize) {
+			plain += WORDS[rng() % WORDS.size()];
+		}
+		plain.resize(a_fileSize);
+
+		std::vector<std::string> data;
+		data.reserve(a_dirCount * a_fileCount);
+
+		archive_type archive;
+		archive.version(bsa::tes4::v105);
+		archive.directory_strings(true);
+		archive.file_strings(true);
+		archive.textures(true);
+		for (std::size_t i = 0; i < a_dirCount; ++i) {
+			for (std::size_t j = 0; j < a_fileCount; ++j) {
+				std::rotate(plain.begin(), plain.begin() + (rng() % plain.size()), plain.end());
+				const auto& file = data.emplace_back(plain);
+				archive.insert(
+					"textures\\bench" + std::to_string(i) + "\\file" + std::to_string(j) + ".dds",
+					{ reinterpret_cast<const std::byte*>(file.data()), file.size() });
+			}
+		}
+
+		archive.compress();
+		archive.write(a_path);
+	}
+
 	static inline const std::array PATHS{
 		filesystem::path{ "E:\\Games\\SteamLibrary\\steamapps\\common\\Oblivion\\Data" },
 		filesystem::path{ "E:\\Games\\SteamLibrary\\steamapps\\common\\Skyrim\\Data" },
@@ -267,6 +900,35 @@ public:
 		});
 	}
 
+	// crc throughput at lengths either side of the folding cutoff, checked against the byte table
+	static void bench_crc()
+	{
+		std::mt19937 rng{ 0 };
+		std::string data(1u << 16, '\0');
+		for (auto& ch : data) {
+			ch = static_cast<char>(rng());
+		}
+
+		for (const std::size_t length : { 16, 48, 256, 4096, 65536 }) {
+			const bsa::stl::string_view view{ data.data(), length };
+			std::uint32_t expected = 0;
+			for (const auto& ch : view) {
+				expected = bsa::fo4::detail::crc32_step(expected, ch);
+			}
+
+			const auto rounds = (std::size_t{ 1 } << 26) / length;
+			std::uint32_t crc = 0;
+			const auto start = std::chrono::steady_clock::now();
+			for (std::size_t i = 0; i < rounds; ++i) {
+				crc = bsa::fo4::detail::crc32(0, view);
+			}
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			const auto total = rounds * length;
+			std::cout << "crc (" << length << " bytes): " << (total / elapsed.count() / 1e9) << " GB/s, " << (crc == expected ? "matching" : "MISMATCHED") << '\n';
+		}
+	}
+
 private:
 	using archive_type = bsa::fo4::archive;
 
@@ -287,11 +949,25 @@ int main(int, const char*[])
 	//tes3::repack();
 	//tes3::write();
 	//tes3::parse();
+	//tes3::pack_path();
+	//tes3::bench_find();
 
 	tes4::parse();
 	//tes4::write();
+	//tes4::bench_lz4();
+	//tes4::bench_extract();
+	//tes4::bench_write();
+	//tes4::literals();
+	//tes4::concurrent();
+	//tes4::hostile_paths();
+	//tes4::no_strings();
+	//tes4::precompressed();
+	//tes4::load_order();
+	//tes4::index_cache();
+	//tes4::bench_find();
 
 	//fo4::parse();
+	//fo4::bench_crc();
 
 	watch.stamp<std::chrono::milliseconds>();
 